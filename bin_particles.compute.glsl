@@ -0,0 +1,18 @@
+#version 450
+layout(local_size_x = 128) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "binning.glsl.h"
+
+// Counts the particles of each bin; Bins is zeroed before this pass
+void main() {
+	uint idx = gl_GlobalInvocationID.x;
+
+	if (idx >= ParticleCount) {
+		return;
+	}
+
+	uint bin = particle_bin(load_position(idx));
+	ParticleBinSlots[idx] = atomicAdd(Bins[bin], 1u);
+}
@@ -1,25 +1,198 @@
 
+// extensions have to be enabled before any declarations
+#ifdef SUBGROUP_DEPOSIT
+#extension GL_KHR_shader_subgroup_ballot : require
+#endif
+
+#include "specialization.glsl.h"
+
 #define PI 3.14159265358979323846
 #define TWO_PI 6.28318530717958647692
 
+// OUTPUT_IMAGE_RG8 builds are used when the device supports two byte storage images, see OutputImageRG8 in main.cpp
+#ifdef OUTPUT_IMAGE_RG8
+layout(set = 0, binding = 0, rg8) uniform image2D OutputImage; // .x trail, .y particle
+#else
 layout(set = 0, binding = 0, rgba8) uniform image2D OutputImage;
+#endif
 layout(set = 0, binding = 1) uniform BoundUniforms {
 	ivec2 ImageSize;
-	uint ParticleCount;
-	uint FrameNumber;
+	uint FirstFrameNumber; // frame number of the frame's first substep, see frame_number
+	uint PresentedFrameNumber; // frames presented so far, advances by one per frame however many substeps it runs
 	uint DensityBufferLength;
 	uint DensityBufferWidth;
 	uint DensityBufferHeight;
+	uint FftWidth; // size of each FftLayers layer, 0 while the FFT engine is not allocated
+	uint FftHeight;
+	uint OccupancyRowWords; // words per row of the occupancy bitmap, 0 while it is not allocated
+	uint OccupancyBitmapLength; // words in each half of OccupancyBitmap
+	uint IncrementalDensity; // DensityField is a single half that update_density keeps current, see density_read_offset
+	uint NeighborRefreshPeriod; // the row prefix engine recounts a particle's neighbors every NeighborRefreshPeriod frames
+	uint NeighborRefreshAll; // recount every particle this frame, because the cached counts are stale
+	uint MeasureRefreshError; // also count the particles steered by cached counts and add up their error in RefreshErrors
+	uint TrailTimestamps; // particles stamp TrailVisits and present_trails draws the image from it, instead of the fade pass
+	uint SpawnCount; // particles spawn_particles adds this frame, in the edit region
+	uint SpawnSeed;
+	float EditRegionX; // disc that particles are spawned into and removed from, in pixels with y up
+	float EditRegionY;
+	float EditRegionRadius;
+};
+// Fast-forward mode runs several simulation substeps per presented frame. Every substep is a frame of its own to the
+// shaders, only the last one's output is shown.
+layout(push_constant) uniform SubstepConstants {
+	uint Substep; // 0 for the first substep of the frame
+	uint LastSubstep;
+};
+
+uint frame_number() {
+	return FirstFrameNumber + Substep;
+}
+
+bool presented_substep() {
+	return Substep == LastSubstep;
+}
+// particle state, accessed through load_position, load_angle and store_particle
+#if PACKED_PARTICLES
+layout(set = 0, binding = 2, std430) buffer ParticleBuffer {
+	uvec2 Particles[]; // x | y << 16, heading
 };
+#else
 layout(set = 0, binding = 2, std430) buffer PositionBuffer {
 	vec2 Positions[];
 };
+#endif
+// unused with PACKED_PARTICLES
 layout(set = 0, binding = 3, std430) buffer AngleBuffer {
 	float Angles[];
 };
 layout(set = 0, binding = 4, std430) buffer DensityFieldBuffer {
 	uint DensityField[];
 };
+// inclusive prefix sums of each row of the density field being read this frame
+layout(set = 0, binding = 5, std430) buffer RowPrefixSumBuffer {
+	uint RowPrefixSums[];
+};
+// particle binning for the tiled simulate kernel, see binning.glsl.h
+// after scan_bins, Bins[tile] is the first slot of the tile in BinnedParticles and Bins[tile count] is the particle count
+layout(set = 0, binding = 6, std430) buffer BinBuffer {
+	uint Bins[];
+};
+layout(set = 0, binding = 7, std430) buffer BinnedParticleBuffer {
+	uint BinnedParticles[];
+};
+// position of each particle within its tile's bin
+layout(set = 0, binding = 8, std430) buffer ParticleBinSlotBuffer {
+	uint ParticleBinSlots[];
+};
+// reorder_particles writes the particles here in bin order; the host copies them back afterwards
+#if PACKED_PARTICLES
+layout(set = 0, binding = 9, std430) buffer ReorderedParticleBuffer {
+	uvec2 ReorderedParticles[];
+};
+#else
+layout(set = 0, binding = 9, std430) buffer ReorderedPositionBuffer {
+	vec2 ReorderedPositions[];
+};
+#endif
+layout(set = 0, binding = 10, std430) buffer ReorderedAngleBuffer {
+	float ReorderedAngles[];
+};
+// stable id of the particle at each index, only maintained with TRACK_PARTICLE_IDS
+layout(set = 0, binding = 11, std430) buffer ParticleIdBuffer {
+	uint ParticleIds[];
+};
+layout(set = 0, binding = 12, std430) buffer ReorderedParticleIdBuffer {
+	uint ReorderedParticleIds[];
+};
+// the positions of BinnedParticles, only written by the cell list's scatter pass
+layout(set = 0, binding = 13, std430) buffer BinnedPositionBuffer {
+	vec2 BinnedPositions[];
+};
+// FFT_LAYER_COUNT complex FftWidth x FftHeight layers, see fft.glsl.h
+layout(set = 0, binding = 14, std430) buffer FftLayerBuffer {
+	vec2 FftLayers[];
+};
+// two halves of the bitmap engine's occupancy bitmap, see occupancy.glsl.h
+layout(set = 0, binding = 15, std430) buffer OccupancyBitmapBuffer {
+	uint OccupancyBitmap[];
+};
+layout(set = 0, binding = 16, std430) buffer OccupancyOverflowFlagBuffer {
+	uint OccupancyOverflowFlags[];
+};
+layout(set = 0, binding = 17, std430) buffer OccupancyOverflowBuffer {
+	uint OccupancyOverflow[];
+};
+// density index of the cell each particle was counted in before this frame's step, only with IncrementalDensity
+layout(set = 0, binding = 18, std430) buffer MovedFromCellBuffer {
+	uint MovedFromCells[];
+};
+// left and right counts of each particle from its last refresh, only used with NeighborRefreshPeriod > 1
+layout(set = 0, binding = 19, std430) buffer NeighborCountBuffer {
+	ivec2 NeighborCounts[];
+};
+// host visible, zeroed by the host before a frame with MeasureRefreshError
+layout(set = 0, binding = 20, std430) buffer RefreshErrorBuffer {
+	uint RefreshErrorCachedParticles;
+	uint RefreshErrorCountSum; // |left - exact left| + |right - exact right|, summed over the cached particles
+	uint RefreshErrorMaxCount;
+	uint RefreshErrorWrongTurns; // cached particles that turned the other way than their exact counts say
+};
+// sin of the first quadrant for FIXED_POINT_MOTION, see fixed_sine in motion.glsl.h
+layout(set = 0, binding = 21, std430) buffer SineTableBuffer {
+	int SineTable[];
+};
+// trail mode: per pixel, row major with y up, 1 + the PresentedFrameNumber a particle last stepped onto it, or 0 if
+// none has. The stamps wrap after 2^32 presented frames (over two years at 60 Hz), see present_trails.compute.glsl.
+layout(set = 0, binding = 22, std430) buffer TrailVisitBuffer {
+	uint TrailVisits[];
+};
+// The live particle count, kept on the GPU. ParticleDispatch holds the vkCmdDispatchIndirect arguments for one
+// invocation per live particle in workgroups of 128, and TunedParticleDispatch the same for the kernels sized by
+// SPEC_ID_PARTICLE_GROUP_SIZE. The spawn and compaction passes leave the new count in PendingParticleCount, which
+// update_particle_count applies once nothing reads the old one.
+layout(set = 0, binding = 23, std430) buffer ParticleCountBuffer {
+	uvec3 ParticleDispatch;
+	uint ParticleCount;
+	uint PendingParticleCount;
+	uint NextParticleId; // id of the next spawned particle, with TRACK_PARTICLE_IDS
+	uint TunedParticleDispatch[3];
+};
+
+#if PACKED_PARTICLES
+// fraction in [0, 1] to 16 bits, rounded to nearest; 1.0 wraps to 0 like the torus does
+uint pack_fraction(float fraction) {
+	return uint(round(fraction * 65536.0)) & 0xFFFFu;
+}
+#endif
+
+vec2 load_position(uint idx) {
+#if PACKED_PARTICLES
+	uint packed_position = Particles[idx].x;
+	vec2 fraction = vec2(packed_position & 0xFFFFu, packed_position >> 16) * (1.0 / 65536.0);
+	return fraction * vec2(ImageSize);
+#else
+	return Positions[idx];
+#endif
+}
+
+float load_angle(uint idx) {
+#if PACKED_PARTICLES
+	return float(Particles[idx].y) * (TWO_PI / 65536.0);
+#else
+	return Angles[idx];
+#endif
+}
+
+void store_particle(uint idx, vec2 position, float angle) {
+#if PACKED_PARTICLES
+	vec2 fraction = position / vec2(ImageSize);
+	uint packed_position = pack_fraction(fraction.x) | (pack_fraction(fraction.y) << 16);
+	Particles[idx] = uvec2(packed_position, pack_fraction(fract(angle * (1.0 / TWO_PI))));
+#else
+	Positions[idx] = position;
+	Angles[idx] = angle;
+#endif
+}
 
 uint multiplier;
 
@@ -61,8 +234,102 @@ vec2 random_vec2(inout uint seed) {
 	return vec2(x, y);
 }
 
+// Stores a new particle with a random heading and returns its position, which FIXED_POINT_MOTION snaps to its grid
+vec2 store_new_particle(uint idx, vec2 position, inout uint seed) {
+#if FIXED_POINT_MOTION
+	// random() is a multiple of 2^-24, so the heading is a whole number of units
+	position = floor(position * float(1 << FIXED_POSITION_BITS)) * (1.0 / float(1 << FIXED_POSITION_BITS));
+	store_particle(idx, position, floor(random(seed) * float(1 << FIXED_ANGLE_BITS)));
+#else
+	store_particle(idx, position, random(seed) * TWO_PI);
+#endif
+	return position;
+}
+
+bool in_edit_region(vec2 position) {
+	vec2 offset = position - vec2(EditRegionX, EditRegionY);
+	return dot(offset, offset) <= EditRegionRadius * EditRegionRadius;
+}
+
+// spaces out the low 16 bits of value so they occupy the even bits
+uint spread_bits(uint value) {
+	value &= 0xFFFFu;
+	value = (value | (value << 8)) & 0x00FF00FFu;
+	value = (value | (value << 4)) & 0x0F0F0F0Fu;
+	value = (value | (value << 2)) & 0x33333333u;
+	value = (value | (value << 1)) & 0x55555555u;
+	return value;
+}
+
+// Index of a density buffer cell within one half of DensityField. Every shader goes through this,
+// and DensityFieldLength in main.cpp sizes the halves to match.
+uint density_index(ivec2 cell) {
+	uvec2 c = uvec2(cell);
+#if DENSITY_LAYOUT == DENSITY_LAYOUT_BLOCKED
+	uint blocks_x = (DensityBufferWidth + DENSITY_BLOCK_SIZE - 1) / DENSITY_BLOCK_SIZE;
+	uvec2 block = c / DENSITY_BLOCK_SIZE;
+	uvec2 within = c % DENSITY_BLOCK_SIZE;
+	return (block.y * blocks_x + block.x) * (DENSITY_BLOCK_SIZE * DENSITY_BLOCK_SIZE) + within.y * DENSITY_BLOCK_SIZE + within.x;
+#elif DENSITY_LAYOUT == DENSITY_LAYOUT_MORTON
+	// the low bits of both sides are interleaved; the longer side's remaining bits go on top. Each side takes the
+	// bits of its size rounded up to a power of two, none for a single cell; mirrors MortonBits in main.cpp.
+	int bits_x = findMSB(DensityBufferWidth - 1) + 1;
+	int bits_y = findMSB(DensityBufferHeight - 1) + 1;
+	int shared_bits = min(bits_x, bits_y);
+	uint low_mask = (1u << shared_bits) - 1;
+	uint high = (c.x >> shared_bits) | (c.y >> shared_bits);
+	return (high << (2 * shared_bits)) | spread_bits(c.x & low_mask) | (spread_bits(c.y & low_mask) << 1);
+#else
+	return c.y * DensityBufferWidth + c.x;
+#endif
+}
+
+// Offsets of the halves of DensityField that are read and written this frame. Normally the halves ping-pong.
+// With IncrementalDensity both are 0: the simulate kernels only read the single half, and update_density moves
+// the counts of the particles that changed cells once every particle has sensed.
+uint density_read_offset() {
+	return (IncrementalDensity != 0 || bool(frame_number() & 0x1)) ? 0 : DensityBufferLength;
+}
+
+uint density_write_offset() {
+	return (IncrementalDensity != 0 || !bool(frame_number() & 0x1)) ? 0 : DensityBufferLength;
+}
+
+// Adds one particle to DensityField[index].
+// The SUBGROUP_DEPOSIT builds first combine the lanes of a subgroup that hit the same cell: each round the
+// first active lane's cell is matched across the subgroup and a single lane adds the whole count. In dense
+// clusters a few rounds drain most of the subgroup; lanes still left after SUBGROUP_DEPOSIT_ROUNDS add one each.
+#define SUBGROUP_DEPOSIT_ROUNDS 4
+
+void deposit_density(uint index) {
+#ifdef SUBGROUP_DEPOSIT
+	for (int round = 0; round < SUBGROUP_DEPOSIT_ROUNDS; ++round) {
+		uint leader_index = subgroupBroadcastFirst(index);
+		bool matches_leader = index == leader_index;
+		uvec4 matching_lanes = subgroupBallot(matches_leader);
+		if (matches_leader) {
+			if (gl_SubgroupInvocationID == subgroupBallotFindLSB(matching_lanes)) {
+				atomicAdd(DensityField[index], subgroupBallotBitCount(matching_lanes));
+			}
+			return;
+		}
+	}
+#endif
+	atomicAdd(DensityField[index], 1u);
+}
+
 // y is up; thanks for coming to my TED talk
 ivec2 flip_y(ivec2 pos) {
 	pos.y = ImageSize.y - 1 - pos.y;
 	return pos;
 }
+
+#ifdef PRESENT_DIRECT
+// the acquired swapchain image, in whatever format the swapchain has
+layout(set = 1, binding = 0) writeonly uniform image2D PresentImage;
+
+// Writes a finished output texel to the swapchain image, with blue 0 and alpha 1 like the blit fills in
+void present_texel(ivec2 texel, vec4 value) {
+	imageStore(PresentImage, texel, vec4(value.xy, 0.0, 1.0));
+}
+#endif
@@ -0,0 +1,64 @@
+// Particles are bucketed into SIMULATE_TILE_SIZE x SIMULATE_TILE_SIZE tiles of the density buffer (row major),
+// along a Z-order curve over the density buffer, or into the cells of the cell list (row major),
+// depending on the BinKey specialization constant
+
+uint tile_count_x() {
+	return (DensityBufferWidth + SIMULATE_TILE_SIZE - 1) / SIMULATE_TILE_SIZE;
+}
+
+uint tile_count() {
+	return tile_count_x() * ((DensityBufferHeight + SIMULATE_TILE_SIZE - 1) / SIMULATE_TILE_SIZE);
+}
+
+uint particle_tile(vec2 position) {
+	uvec2 cell = uvec2(position / DensityBufferDownscale);
+	uvec2 tile = cell / SIMULATE_TILE_SIZE;
+	return tile.y * tile_count_x() + tile.x;
+}
+
+// Morton code of the particle's cell, truncated to MORTON_BIN_BITS: the density buffer is cut into
+// power of two blocks small enough that 256 of them cover each axis, and the blocks are numbered along the curve
+uint particle_morton_bin(vec2 position) {
+	uvec2 cell = uvec2(position / DensityBufferDownscale);
+	int block_shift = max(0, findMSB(max(DensityBufferWidth, DensityBufferHeight) - 1) + 1 - MORTON_BIN_BITS / 2);
+	uvec2 block = cell >> block_shift;
+	return spread_bits(block.x) | (spread_bits(block.y) << 1);
+}
+
+// The image is split into as many cells of at least CellListCellSize pixels as fit, so the cells
+// tile it exactly and the 3x3 cells around a particle cover its disc even across the wrap
+ivec2 cell_list_size() {
+	return max(ImageSize / CellListCellSize, ivec2(1));
+}
+
+// With FIXED_POINT_MOTION the cells are cut at whole pixels in integer arithmetic, so every device bins alike.
+// Each cell is still at least CellListCellSize pixels wide.
+ivec2 particle_cell(vec2 position) {
+	ivec2 cells = cell_list_size();
+#if FIXED_POINT_MOTION
+	ivec2 cell = ivec2(position) * cells / ImageSize;
+#else
+	ivec2 cell = ivec2(position * vec2(cells) / vec2(ImageSize));
+#endif
+	return min(cell, cells - 1);
+}
+
+uint bin_count() {
+	if (BinKey == BIN_KEY_MORTON) {
+		return MORTON_BIN_COUNT;
+	} else if (BinKey == BIN_KEY_CELL) {
+		ivec2 cells = cell_list_size();
+		return uint(cells.x * cells.y);
+	}
+	return tile_count();
+}
+
+uint particle_bin(vec2 position) {
+	if (BinKey == BIN_KEY_MORTON) {
+		return particle_morton_bin(position);
+	} else if (BinKey == BIN_KEY_CELL) {
+		ivec2 cell = particle_cell(position);
+		return uint(cell.y * cell_list_size().x + cell.x);
+	}
+	return particle_tile(position);
+}
@@ -12,32 +12,79 @@ if (-not $VULKAN_SDK) {
     exit 1
 }
 
-if ($shaders) {
-	Write-Host "Compiling shaders:" -ForegroundColor Cyan
+# The SPIR-V headers are generated: a header is compiled when it is missing or older than any shader source,
+# and -shaders compiles all of them
+$ShaderSources = Get-ChildItem -Path .\* -Include *.glsl, *.glsl.h, shared_constants.h
+$NewestShaderSource = ($ShaderSources | Measure-Object -Property LastWriteTime -Maximum).Maximum
 
-	$commands = @(
-		"glslc -mfmt=c -fshader-stage=compute .\clear.compute.glsl -o clear.compute.h",
-		"glslc -mfmt=c -fshader-stage=compute .\reset.compute.glsl -o reset.compute.h",
-		"glslc -mfmt=c -fshader-stage=compute .\fade.compute.glsl -o fade.compute.h",
-		"glslc -mfmt=c -fshader-stage=compute .\simulate.compute.glsl -o simulate.compute.h"
-		"glslc -mfmt=c -fshader-stage=compute .\render_density_buffer.compute.glsl -o render_density_buffer.compute.h"
-	)
+Write-Host "Compiling shaders:" -ForegroundColor Cyan
+$commands = @(
+	"glslc -mfmt=c -fshader-stage=compute .\clear.compute.glsl -o clear.compute.h",
+	"glslc -mfmt=c -fshader-stage=compute .\reset.compute.glsl -o reset.compute.h",
+	"glslc -mfmt=c -fshader-stage=compute .\fade.compute.glsl -o fade.compute.h",
+	"glslc -mfmt=c -fshader-stage=compute .\simulate.compute.glsl -o simulate.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\render_density_buffer.compute.glsl -o render_density_buffer.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\row_prefix_sum.compute.glsl -o row_prefix_sum.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DFUSED_FADE .\row_prefix_sum.compute.glsl -o row_prefix_sum_fused.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\bin_particles.compute.glsl -o bin_particles.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\scan_bins.compute.glsl -o scan_bins.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\scatter_bins.compute.glsl -o scatter_bins.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\simulate_tiled.compute.glsl -o simulate_tiled.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\reorder_particles.compute.glsl -o reorder_particles.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\simulate_cell_list.compute.glsl -o simulate_cell_list.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\fft_load.compute.glsl -o fft_load.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\fft_kernels.compute.glsl -o fft_kernels.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\fft_lines.compute.glsl -o fft_lines.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\fft_multiply.compute.glsl -o fft_multiply.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\simulate_fft.compute.glsl -o simulate_fft.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\simulate_bitmap.compute.glsl -o simulate_bitmap.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DOCCUPANCY_BITMAP .\reset.compute.glsl -o reset_bitmap.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\update_density.compute.glsl -o update_density.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\present_trails.compute.glsl -o present_trails.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\spawn_particles.compute.glsl -o spawn_particles.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\update_particle_count.compute.glsl -o update_particle_count.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute .\compact_particles.compute.glsl -o compact_count.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DCOMPACT_SCAN .\compact_particles.compute.glsl -o compact_scan.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DCOMPACT_SCATTER .\compact_particles.compute.glsl -o compact_scatter.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DPRESENT_DIRECT .\fade.compute.glsl -o fade_direct.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DPRESENT_DIRECT -DFUSED_FADE .\row_prefix_sum.compute.glsl -o row_prefix_sum_fused_direct.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DPRESENT_DIRECT .\present_trails.compute.glsl -o present_trails_direct.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DOUTPUT_IMAGE_RG8 .\clear.compute.glsl -o clear_rg8.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DOUTPUT_IMAGE_RG8 .\fade.compute.glsl -o fade_rg8.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DOUTPUT_IMAGE_RG8 .\render_density_buffer.compute.glsl -o render_density_buffer_rg8.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DOUTPUT_IMAGE_RG8 -DFUSED_FADE .\row_prefix_sum.compute.glsl -o row_prefix_sum_fused_rg8.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DOUTPUT_IMAGE_RG8 .\present_trails.compute.glsl -o present_trails_rg8.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DOUTPUT_IMAGE_RG8 -DPRESENT_DIRECT .\fade.compute.glsl -o fade_direct_rg8.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute -DOUTPUT_IMAGE_RG8 -DPRESENT_DIRECT -DFUSED_FADE .\row_prefix_sum.compute.glsl -o row_prefix_sum_fused_direct_rg8.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute --target-env=vulkan1.1 -DSUBGROUP_DEPOSIT .\reset.compute.glsl -o reset_subgroup.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute --target-env=vulkan1.1 -DSUBGROUP_DEPOSIT .\simulate.compute.glsl -o simulate_subgroup.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute --target-env=vulkan1.1 -DSUBGROUP_DEPOSIT .\simulate_tiled.compute.glsl -o simulate_tiled_subgroup.compute.h"
+	"glslc -mfmt=c -fshader-stage=compute --target-env=vulkan1.1 -DSUBGROUP_DEPOSIT .\simulate_cell_list.compute.glsl -o simulate_cell_list_subgroup.compute.h"
+)
 
-	foreach ($CMD in $commands) {
-		Write-Host $CMD -ForegroundColor Yellow
-		if ($debug) {
-			Invoke-Expression "$CMD -g"
-		} else {
-			Invoke-Expression "$CMD -O"
-		}
-		if ($LASTEXITCODE -eq 0) {
-			Write-Host "Shader compilation successful!" -ForegroundColor Green
-		} else {
-			Write-Host "Shader compilation successful failed" -ForegroundColor Red
-			exit 1
-		}
-		Write-Host ""
+foreach ($CMD in $commands) {
+	$Output = ($CMD -split ' ')[-1]
+	if (-not $shaders -and (Test-Path $Output) -and (Get-Item $Output).LastWriteTime -ge $NewestShaderSource) {
+		continue
+	}
+	# only needed once a header is out of date, a checkout with current headers builds without it
+	if (-not (Get-Command glslc -ErrorAction SilentlyContinue)) {
+		Write-Host "Error: glslc not found, $Output has to be compiled. glslc ships with the Vulkan SDK, add $VULKAN_SDK\Bin to PATH." -ForegroundColor Red
+		exit 1
+	}
+	Write-Host $CMD -ForegroundColor Yellow
+	if ($debug) {
+		Invoke-Expression "$CMD -g"
+	} else {
+		Invoke-Expression "$CMD -O"
+	}
+	if ($LASTEXITCODE -eq 0) {
+		Write-Host "Shader compilation successful!" -ForegroundColor Green
+	} else {
+		Write-Host "Shader compilation successful failed" -ForegroundColor Red
+		exit 1
 	}
+	Write-Host ""
 }
 
 # Compiler and output settings
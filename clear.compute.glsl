@@ -1,8 +1,8 @@
 #version 450
-layout(local_size_x = 16, local_size_y = 16) in;
-
-#include "bindings.glsl.h"
 #include "shared_constants.h"
+// the shape is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_IMAGE_GROUP_WIDTH, local_size_y_id = SPEC_ID_IMAGE_GROUP_HEIGHT) in;
+#include "bindings.glsl.h"
 
 void main() {
 	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
@@ -14,6 +14,7 @@ void main() {
 	vec3 color = vec3(0.0);
 	imageStore(OutputImage, texel, vec4(color, 1.0));
 
-	uint index = (texel.y / DENSITY_BUFFER_DOWNSCALE) * (ImageSize.y / DENSITY_BUFFER_DOWNSCALE) + (texel.x / DENSITY_BUFFER_DOWNSCALE);
-	DensityField[index] = 0;
+	if (DensityBufferLength != 0) {
+		DensityField[density_index(texel / DensityBufferDownscale)] = 0;
+	}
 }
@@ -0,0 +1,73 @@
+#version 450
+layout(local_size_x = 128) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "scan.glsl.h"
+
+// Removes the particles inside the edit region by prefix sum compaction, keeping the order of the others.
+// The default build counts the survivors of each workgroup of 128 particles into CompactionSums, the
+// COMPACT_SCAN build turns those into exclusive offsets, and the COMPACT_SCATTER build writes every survivor to its
+// workgroup's offset plus its rank within the workgroup in the reordered buffers. The host copies them back.
+// CompactionSums aliases Bins, which the binning passes rebuild before every use.
+#define CompactionSums Bins
+
+#ifdef COMPACT_SCAN
+// Single workgroup. The survivor total goes to PendingParticleCount, as the scatter still runs over the old count.
+void main() {
+	uint lane = gl_LocalInvocationID.x;
+	uint group_count = (ParticleCount + SCAN_GROUP_SIZE - 1) / SCAN_GROUP_SIZE;
+	uint carry = 0;
+
+	for (uint chunk = 0; chunk < group_count; chunk += SCAN_GROUP_SIZE) {
+		uint group = chunk + lane;
+		uint value = (group < group_count) ? CompactionSums[group] : 0;
+
+		uint chunk_total;
+		uint prefix = workgroup_inclusive_scan(value, chunk_total);
+
+		if (group < group_count) {
+			CompactionSums[group] = carry + prefix - value;
+		}
+		carry += chunk_total;
+	}
+
+	if (lane == 0) {
+		PendingParticleCount = carry;
+	}
+}
+#else
+void main() {
+	uint idx = gl_GlobalInvocationID.x;
+
+	// no early return, every invocation takes part in the scan
+	bool live = idx < ParticleCount;
+	vec2 position = live ? load_position(idx) : vec2(0.0);
+	bool keep = live && !in_edit_region(position);
+
+	uint survivors;
+	uint rank = workgroup_inclusive_scan(keep ? 1 : 0, survivors);
+
+#ifdef COMPACT_SCATTER
+	if (keep) {
+		uint destination = CompactionSums[gl_WorkGroupID.x] + rank - 1;
+#if PACKED_PARTICLES
+		ReorderedParticles[destination] = Particles[idx];
+#else
+		ReorderedPositions[destination] = position;
+		ReorderedAngles[destination] = Angles[idx];
+#endif
+#if TRACK_PARTICLE_IDS
+		ReorderedParticleIds[destination] = ParticleIds[idx];
+#endif
+	} else if (live && IncrementalDensity != 0 && DensityBufferLength != 0) {
+		// a rebuilt density field drops the particle with the next step
+		atomicAdd(DensityField[density_index(ivec2(position / DensityBufferDownscale))], ~0u);
+	}
+#else
+	if (gl_LocalInvocationID.x == 0) {
+		CompactionSums[gl_WorkGroupID.x] = survivors;
+	}
+#endif
+}
+#endif
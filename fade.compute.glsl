@@ -1,8 +1,10 @@
 #version 450
-layout(local_size_x = 16, local_size_y = 16) in;
-
-#include "bindings.glsl.h"
 #include "shared_constants.h"
+// the shape is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_IMAGE_GROUP_WIDTH, local_size_y_id = SPEC_ID_IMAGE_GROUP_HEIGHT) in;
+#include "bindings.glsl.h"
+#include "occupancy.glsl.h"
+#include "fade.glsl.h"
 
 void main() {
 	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
@@ -11,15 +13,12 @@ void main() {
 		return;
 	}
 
-	vec4 value = imageLoad(OutputImage, texel);
-	value.x *= 0.9525;
-	value.x *= step(0.125, value.x);
-	value.y = 0.0;
-
-	uint clear_offset = bool(FrameNumber & 0x1) ? DensityBufferLength : 0;
-	ivec2 position = ivec2(texel / DENSITY_BUFFER_DOWNSCALE);
-	uint index = position.y * DensityBufferWidth + position.x;
-	DensityField[clear_offset + index] = 0;
+	// the density field is not allocated while the occupancy bitmap stands in for it,
+	// and is updated in place instead of being rebuilt with IncrementalDensity
+	if (DensityBufferLength != 0 && IncrementalDensity == 0) {
+		ivec2 position = ivec2(texel / DensityBufferDownscale);
+		DensityField[density_write_offset() + density_index(position)] = 0;
+	}
 
-	imageStore(OutputImage, texel, value);
+	shade_texel(texel);
 }
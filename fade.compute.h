@@ -1,133 +0,0 @@
-{0x07230203,0x00010000,0x000d000b,0x00000097,
-0x00000000,0x00020011,0x00000001,0x0006000b,
-0x00000001,0x4c534c47,0x6474732e,0x3035342e,
-0x00000000,0x0003000e,0x00000000,0x00000001,
-0x0006000f,0x00000005,0x00000004,0x6e69616d,
-0x00000000,0x0000000d,0x00060010,0x00000004,
-0x00000011,0x00000010,0x00000010,0x00000001,
-0x00040047,0x0000000d,0x0000000b,0x0000001c,
-0x00050048,0x00000017,0x00000000,0x00000023,
-0x00000000,0x00050048,0x00000017,0x00000001,
-0x00000023,0x00000008,0x00050048,0x00000017,
-0x00000002,0x00000023,0x0000000c,0x00050048,
-0x00000017,0x00000003,0x00000023,0x00000010,
-0x00050048,0x00000017,0x00000004,0x00000023,
-0x00000014,0x00050048,0x00000017,0x00000005,
-0x00000023,0x00000018,0x00030047,0x00000017,
-0x00000002,0x00040047,0x00000019,0x00000022,
-0x00000000,0x00040047,0x00000019,0x00000021,
-0x00000001,0x00040047,0x00000032,0x00000022,
-0x00000000,0x00040047,0x00000032,0x00000021,
-0x00000000,0x00040047,0x0000006a,0x00000006,
-0x00000004,0x00050048,0x0000006b,0x00000000,
-0x00000023,0x00000000,0x00030047,0x0000006b,
-0x00000003,0x00040047,0x0000006d,0x00000022,
-0x00000000,0x00040047,0x0000006d,0x00000021,
-0x00000004,0x00040047,0x00000076,0x0000000b,
-0x00000019,0x00020013,0x00000002,0x00030021,
-0x00000003,0x00000002,0x00040015,0x00000006,
-0x00000020,0x00000001,0x00040017,0x00000007,
-0x00000006,0x00000002,0x00040015,0x0000000a,
-0x00000020,0x00000000,0x00040017,0x0000000b,
-0x0000000a,0x00000003,0x00040020,0x0000000c,
-0x00000001,0x0000000b,0x0004003b,0x0000000c,
-0x0000000d,0x00000001,0x00040017,0x0000000e,
-0x0000000a,0x00000002,0x00020014,0x00000012,
-0x0004002b,0x0000000a,0x00000013,0x00000000,
-0x0008001e,0x00000017,0x00000007,0x0000000a,
-0x0000000a,0x0000000a,0x0000000a,0x0000000a,
-0x00040020,0x00000018,0x00000002,0x00000017,
-0x0004003b,0x00000018,0x00000019,0x00000002,
-0x0004002b,0x00000006,0x0000001a,0x00000000,
-0x00040020,0x0000001b,0x00000002,0x00000006,
-0x0004002b,0x0000000a,0x00000022,0x00000001,
-0x00030016,0x0000002c,0x00000020,0x00040017,
-0x0000002d,0x0000002c,0x00000004,0x00090019,
-0x00000030,0x0000002c,0x00000001,0x00000000,
-0x00000000,0x00000000,0x00000002,0x00000004,
-0x00040020,0x00000031,0x00000000,0x00000030,
-0x0004003b,0x00000031,0x00000032,0x00000000,
-0x0004002b,0x0000002c,0x00000036,0x3f73d70a,
-0x0004002b,0x0000002c,0x0000003c,0x3e000000,
-0x0004002b,0x0000002c,0x00000044,0x00000000,
-0x0004002b,0x00000006,0x00000048,0x00000002,
-0x00040020,0x00000049,0x00000002,0x0000000a,
-0x0004002b,0x00000006,0x00000051,0x00000003,
-0x0004002b,0x00000006,0x00000058,0x00000001,
-0x0004002b,0x00000006,0x00000062,0x00000004,
-0x0003001d,0x0000006a,0x0000000a,0x0003001e,
-0x0000006b,0x0000006a,0x00040020,0x0000006c,
-0x00000002,0x0000006b,0x0004003b,0x0000006c,
-0x0000006d,0x00000002,0x0004002b,0x0000000a,
-0x00000075,0x00000010,0x0006002c,0x0000000b,
-0x00000076,0x00000075,0x00000075,0x00000022,
-0x0005002c,0x00000007,0x00000096,0x00000058,
-0x00000058,0x00050036,0x00000002,0x00000004,
-0x00000000,0x00000003,0x000200f8,0x00000005,
-0x000300f7,0x00000082,0x00000000,0x000300fb,
-0x00000013,0x00000083,0x000200f8,0x00000083,
-0x0004003d,0x0000000b,0x0000000f,0x0000000d,
-0x0007004f,0x0000000e,0x00000010,0x0000000f,
-0x0000000f,0x00000000,0x00000001,0x0004007c,
-0x00000007,0x00000011,0x00000010,0x00050051,
-0x00000006,0x00000016,0x00000011,0x00000000,
-0x00060041,0x0000001b,0x0000001c,0x00000019,
-0x0000001a,0x00000013,0x0004003d,0x00000006,
-0x0000001d,0x0000001c,0x000500af,0x00000012,
-0x0000001e,0x00000016,0x0000001d,0x000400a8,
-0x00000012,0x0000001f,0x0000001e,0x000300f7,
-0x00000021,0x00000000,0x000400fa,0x0000001f,
-0x00000020,0x00000021,0x000200f8,0x00000020,
-0x00050051,0x00000006,0x00000024,0x00000011,
-0x00000001,0x00060041,0x0000001b,0x00000025,
-0x00000019,0x0000001a,0x00000022,0x0004003d,
-0x00000006,0x00000026,0x00000025,0x000500af,
-0x00000012,0x00000027,0x00000024,0x00000026,
-0x000200f9,0x00000021,0x000200f8,0x00000021,
-0x000700f5,0x00000012,0x00000028,0x0000001e,
-0x00000083,0x00000027,0x00000020,0x000300f7,
-0x0000002a,0x00000000,0x000400fa,0x00000028,
-0x00000029,0x0000002a,0x000200f8,0x00000029,
-0x000200f9,0x00000082,0x000200f8,0x0000002a,
-0x0004003d,0x00000030,0x00000033,0x00000032,
-0x00050062,0x0000002d,0x00000035,0x00000033,
-0x00000011,0x00050051,0x0000002c,0x00000039,
-0x00000035,0x00000000,0x00050085,0x0000002c,
-0x0000003a,0x00000039,0x00000036,0x0007000c,
-0x0000002c,0x0000003f,0x00000001,0x00000030,
-0x0000003c,0x0000003a,0x00050085,0x0000002c,
-0x00000042,0x0000003a,0x0000003f,0x00060052,
-0x0000002d,0x00000090,0x00000042,0x00000035,
-0x00000000,0x00060052,0x0000002d,0x00000092,
-0x00000044,0x00000090,0x00000001,0x00050041,
-0x00000049,0x0000004a,0x00000019,0x00000048,
-0x0004003d,0x0000000a,0x0000004b,0x0000004a,
-0x000500c7,0x0000000a,0x0000004c,0x0000004b,
-0x00000022,0x000500ab,0x00000012,0x0000004d,
-0x0000004c,0x00000013,0x000300f7,0x00000050,
-0x00000000,0x000400fa,0x0000004d,0x0000004f,
-0x00000054,0x000200f8,0x0000004f,0x00050041,
-0x00000049,0x00000052,0x00000019,0x00000051,
-0x0004003d,0x0000000a,0x00000053,0x00000052,
-0x000200f9,0x00000050,0x000200f8,0x00000054,
-0x000200f9,0x00000050,0x000200f8,0x00000050,
-0x000700f5,0x0000000a,0x00000095,0x00000053,
-0x0000004f,0x00000013,0x00000054,0x00050087,
-0x00000007,0x0000005a,0x00000011,0x00000096,
-0x00050051,0x00000006,0x00000060,0x0000005a,
-0x00000001,0x0004007c,0x0000000a,0x00000061,
-0x00000060,0x00050041,0x00000049,0x00000063,
-0x00000019,0x00000062,0x0004003d,0x0000000a,
-0x00000064,0x00000063,0x00050084,0x0000000a,
-0x00000065,0x00000061,0x00000064,0x00050051,
-0x00000006,0x00000067,0x0000005a,0x00000000,
-0x0004007c,0x0000000a,0x00000068,0x00000067,
-0x00050080,0x0000000a,0x00000069,0x00000065,
-0x00000068,0x00050080,0x0000000a,0x00000070,
-0x00000095,0x00000069,0x00060041,0x00000049,
-0x00000071,0x0000006d,0x0000001a,0x00000070,
-0x0003003e,0x00000071,0x00000013,0x0004003d,
-0x00000030,0x00000072,0x00000032,0x00040063,
-0x00000072,0x00000011,0x00000092,0x000200f9,
-0x00000082,0x000200f8,0x00000082,0x000100fd,
-0x00010038}
@@ -0,0 +1,29 @@
+// Shades one output texel: fades its red trail channel and sets its green particle channel from the cell the
+// previous frame's step deposited into, which is the half this frame reads. Gathering per pixel replaces a
+// scattered imageStore per particle in the simulate kernels, at the cost of showing the particles one step late.
+// At a downscale above 1 a whole cell lights up. Needs occupancy.glsl.h for the bitmap engine.
+// Shared by fade.compute.glsl and the FUSED_FADE build of row_prefix_sum.compute.glsl.
+// In trail mode present_trails draws the whole image instead, and in fast-forward mode only the presented substep shades.
+void shade_texel(ivec2 texel) {
+	if (TrailTimestamps != 0 || !presented_substep()) {
+		return;
+	}
+
+	ivec2 cell = flip_y(texel) / DensityBufferDownscale;
+	uint particle_count;
+	if (DensityBufferLength != 0) {
+		particle_count = DensityField[density_read_offset() + density_index(cell)];
+	} else {
+		uint read_parity = bool(frame_number() & 0x1) ? 0 : 1;
+		particle_count = uint(occupancy_span_count(read_parity, cell.y, cell.x, cell.x));
+	}
+
+	vec4 value = imageLoad(OutputImage, texel);
+	value.x *= TRAIL_DECAY;
+	value.x *= step(TRAIL_CUTOFF, value.x);
+	value.y = (particle_count != 0) ? 1.0 : 0.0;
+	imageStore(OutputImage, texel, value);
+#ifdef PRESENT_DIRECT
+	present_texel(texel, value);
+#endif
+}
@@ -0,0 +1,18 @@
+// Helpers for the FFT engine. Each layer of FftLayers is a row major FftWidth x FftHeight grid of complex values.
+// Density buffer cell c sits at c + FFT_HALO in a layer, surrounded by a wrapped copy of the opposite edges.
+
+vec2 complex_multiply(vec2 a, vec2 b) {
+	return vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+uint fft_layer_start(uint layer) {
+	return layer * FftWidth * FftHeight;
+}
+
+// Number of particles the kernel read from the response layers finds around a density buffer cell.
+// Kernel i is the left half-disc of orientation bin i, and kernel FFT_ORIENTATION_BINS is the whole disc.
+int fft_response(uint kernel, ivec2 cell) {
+	ivec2 padded = cell + FFT_HALO;
+	vec2 value = FftLayers[fft_layer_start(FFT_FIRST_RESPONSE_LAYER + kernel / 2) + padded.y * FftWidth + padded.x];
+	return int(round((kernel % 2 == 0) ? value.x : value.y));
+}
@@ -0,0 +1,40 @@
+#version 450
+layout(local_size_x = 16, local_size_y = 16) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "fft.glsl.h"
+
+// Writes the sensing kernels into the kernel layers before they are transformed, kernel 2i in the real part
+// and kernel 2i + 1 in the imaginary part of layer FFT_FIRST_KERNEL_LAYER + i. The layers are multiplied
+// with the density spectrum, which convolves, so each kernel is stored mirrored to count cell + offset.
+void main() {
+	ivec2 position = ivec2(gl_GlobalInvocationID.xy);
+	uint pair = gl_GlobalInvocationID.z;
+	if (position.x >= FftWidth || position.y >= FftHeight) {
+		return;
+	}
+
+	ivec2 fft_size = ivec2(FftWidth, FftHeight);
+	ivec2 wrapped = mix(position, position - fft_size, greaterThanEqual(position, fft_size / 2));
+	ivec2 offset = -wrapped;
+
+	vec2 weights = vec2(0.0);
+	if (offset.x * offset.x + offset.y * offset.y <= SearchRadiusSquared) {
+		for (uint component = 0; component < 2; ++component) {
+			uint kernel = pair * 2 + component;
+			float weight = 0.0;
+			if (kernel < FFT_ORIENTATION_BINS) {
+				// same left test as count_neighbors in sensing.glsl.h, for the bin's central heading
+				float angle = TWO_PI * float(kernel) / float(FFT_ORIENTATION_BINS);
+				vec2 direction = vec2(cos(angle), sin(angle));
+				weight = (float(offset.x) * direction.y < float(offset.y) * direction.x) ? 1.0 : 0.0;
+			} else if (kernel == FFT_ORIENTATION_BINS) {
+				weight = 1.0;
+			}
+			weights[component] = weight;
+		}
+	}
+
+	FftLayers[fft_layer_start(FFT_FIRST_KERNEL_LAYER + pair) + position.y * FftWidth + position.x] = weights;
+}
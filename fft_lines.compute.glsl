@@ -0,0 +1,46 @@
+#version 450
+layout(local_size_x = 256) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "fft.glsl.h"
+
+// Radix-2 FFT of one row (FftAxis 0) or column (FftAxis 1) per workgroup, in place in shared memory.
+// gl_WorkGroupID.y selects the layer, counting from FftFirstLayer. The inverse transform is scaled by 1 / length,
+// so a row pass followed by a column pass inverts the forward 2D transform.
+shared vec2 fft_data[FFT_MAX_SIZE];
+
+void main() {
+	uint lane = gl_LocalInvocationID.x;
+	uint line_length = (FftAxis == 0) ? FftWidth : FftHeight;
+	uint stride = (FftAxis == 0) ? 1 : FftWidth;
+	uint line_start = fft_layer_start(FftFirstLayer + gl_WorkGroupID.y) +
+		((FftAxis == 0) ? gl_WorkGroupID.x * FftWidth : gl_WorkGroupID.x);
+	int bits = findMSB(line_length);
+
+	for (uint i = lane; i < line_length; i += gl_WorkGroupSize.x) {
+		fft_data[bitfieldReverse(i) >> (32 - bits)] = FftLayers[line_start + i * stride];
+	}
+	barrier();
+
+	float direction = FftInverse ? 1.0 : -1.0;
+	for (uint half_size = 1; half_size < line_length; half_size <<= 1) {
+		for (uint j = lane; j < line_length / 2; j += gl_WorkGroupSize.x) {
+			uint k = j & (half_size - 1);
+			uint even_index = (j - k) * 2 + k;
+			uint odd_index = even_index + half_size;
+
+			float angle = direction * PI * float(k) / float(half_size);
+			vec2 odd = complex_multiply(vec2(cos(angle), sin(angle)), fft_data[odd_index]);
+			vec2 even = fft_data[even_index];
+			fft_data[even_index] = even + odd;
+			fft_data[odd_index] = even - odd;
+		}
+		barrier();
+	}
+
+	float scale = FftInverse ? 1.0 / float(line_length) : 1.0;
+	for (uint i = lane; i < line_length; i += gl_WorkGroupSize.x) {
+		FftLayers[line_start + i * stride] = fft_data[i] * scale;
+	}
+}
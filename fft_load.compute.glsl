@@ -0,0 +1,25 @@
+#version 450
+layout(local_size_x = 16, local_size_y = 16) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "fft.glsl.h"
+
+// Copies the density field being read this frame into FFT layer 0, padded with FFT_HALO wrapped cells on every side
+// so the circular convolution of the transform matches the toroidal wrap of the simulation
+void main() {
+	ivec2 padded = ivec2(gl_GlobalInvocationID.xy);
+	if (padded.x >= FftWidth || padded.y >= FftHeight) {
+		return;
+	}
+
+	ivec2 density_buffer_size = ivec2(DensityBufferWidth, DensityBufferHeight);
+	float density = 0.0;
+	if (all(lessThan(padded, density_buffer_size + 2 * FFT_HALO))) {
+		uint read_offset = density_read_offset();
+		ivec2 cell = (padded - FFT_HALO + density_buffer_size) % density_buffer_size;
+		density = float(DensityField[read_offset + density_index(cell)]);
+	}
+
+	FftLayers[padded.y * FftWidth + padded.x] = vec2(density, 0.0);
+}
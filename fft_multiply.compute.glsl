@@ -0,0 +1,20 @@
+#version 450
+layout(local_size_x = 256) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "fft.glsl.h"
+
+// Multiplies the density spectrum with each kernel pair's spectrum. As the density is real, the inverse transform
+// of each product holds the response to the pair's first kernel in the real and the second in the imaginary part.
+void main() {
+	uint index = gl_GlobalInvocationID.x;
+	uint pair = gl_GlobalInvocationID.y;
+	if (index >= FftWidth * FftHeight) {
+		return;
+	}
+
+	vec2 density = FftLayers[index];
+	vec2 kernel = FftLayers[fft_layer_start(FFT_FIRST_KERNEL_LAYER + pair) + index];
+	FftLayers[fft_layer_start(FFT_FIRST_RESPONSE_LAYER + pair) + index] = complex_multiply(density, kernel);
+}
@@ -5,24 +5,65 @@
 #define GLFW_INCLUDE_VULKAN
 #include "GLFW/glfw3.h"
 
+#include <atomic>
+#include <math.h>
+#include <thread>
+
 static VkInstance Instance;
 static VkDevice Device;
 static VkPhysicalDevice PhysicalDevice;
 static VkQueue Queue;
+// The simulation runs on ComputeQueue. When the device has a compute family without graphics, AsyncCompute is set and
+// that family's queue simulates the next frame while Queue blits and presents the last one. Otherwise it is Queue.
+static VkQueue ComputeQueue;
+static bool AsyncCompute = false;
 static VkDeviceMemory DeviceMemory;
 
 static constexpr u32 MaxSwapchainImageCount = 4;
-static constexpr u32 FramesInFlight = 1;
+// the host records frame N + 1 while the GPU runs frame N; each frame has its own command buffer, uniform slice
+// and descriptor set
+static constexpr u32 FramesInFlight = 2;
 static constexpr u32 MaxParticleCount = MAX_PARTICLE_COUNT;
-static u32 ParticleCount = MaxParticleCount;
+// a vec2 position, or with PACKED_PARTICLES 16 bit x, y and heading in two words
+static constexpr u64 ParticleElementSize = PACKED_PARTICLES ? 2 * sizeof(u32) : sizeof(v2);
+// The live particle count is kept on the GPU, see ParticleCountBuffer in bindings.glsl.h. The host only knows the
+// count a reset starts with and an upper bound, which grows with every spawn and is reset with the particles.
+static u32 ResetParticleCount = MaxParticleCount;
+static u32 ParticleCountBound = MaxParticleCount;
+// N spawns a batch around the cursor and X removes the particles around it, on the next frame
+static bool SpawnRequested = false;
+static bool DespawnRequested = false;
+// set when the particle workgroup size changed, so the dispatch arguments on the GPU are rebuilt before the next use
+static bool ParticleDispatchStale = false;
+static v2 EditRegion = {};
+// the number of simulation steps run so far; in fast-forward mode it advances by SubstepCount per presented frame
 static u32 FrameNumber = 0;
+// the number of frames presented so far, trail stamps count in these so fast-forward doesn't change how long they last
+static u32 PresentedFrameNumber = 0;
+// Fast-forward mode (G): each presented frame records SubstepCount fade and simulate iterations into its submission,
+// and a governor picks SubstepCount to keep the frame time near FastForwardFrameTime. Only the last substep shades
+// the image and stamps trails. Without it SubstepCount is 1.
+static bool FastForward = false;
+static u32 SubstepCount = 1;
+static constexpr u32 MaxSubstepCount = 256;
+static constexpr f64 FastForwardFrameTime = 1.0 / 30.0;
+static f64 LastFrameStartTime = 0.0;
+static f64 SmoothedFrameTime = 0.0;
+// frames the governor waits after a change, until the frames it measures were recorded with the new count
+static u32 GovernorHoldFrames = 0;
 static bool ResetParticleState = true;
 
 static u32 SwapchainImageCount = 0;
 
 static VkSemaphore ImageAvailableSemaphores[FramesInFlight];
 static VkSemaphore RenderFinishedSemaphores[FramesInFlight];
-static VkFence InFlightFences[FramesInFlight];
+// signaled by the compute submission of an AsyncCompute frame, waited on by its blit
+static VkSemaphore ComputeFinishedSemaphores[FramesInFlight];
+// Every submit signals the next value of FrameTimeline. A frame slot is reused once the value its last submit
+// signaled, FrameTimelineValues[slot], is reached.
+static VkSemaphore FrameTimeline;
+static u64 FrameTimelineValue = 0;
+static u64 FrameTimelineValues[FramesInFlight];
 
 static VkPipeline Pipeline;
 static VkSurfaceKHR Surface;
@@ -34,41 +75,317 @@ static u32 DensityBufferWidth = 0;
 static u32 DensityBufferHeight = 0;
 
 static u32 QueueFamilyIndex = -1;
+static u32 ComputeQueueFamilyIndex = -1;
 static VkImage SwapchainImages[MaxSwapchainImageCount];
 
+// CommandPool is for Queue and ComputeCommandPool for ComputeQueue; they are the same without AsyncCompute
 static VkCommandPool CommandPool;
+static VkCommandPool ComputeCommandPool;
 static VkCommandBuffer CommandBuffers[FramesInFlight];
 
 static VkDescriptorSetLayout DescriptorSetLayout;
-static VkDescriptorSet DescriptorSet;
+// one per frame in flight, identical but for the slice of the uniform buffer they bind
+static VkDescriptorSet DescriptorSets[FramesInFlight];
+// uniform_data rounded up to minUniformBufferOffsetAlignment, the distance between the frames' slices
+static VkDeviceSize UniformStride = 0;
 static VkPipelineLayout PipelineLayout;
 static VkImage OutputImage;
 static VkImageView OutputImageView;
+// With AsyncCompute the compute queue copies OutputImage into its frame's image and hands that to the graphics queue
+// for the blit, so the next frame can shade OutputImage in the meantime. They are 1x1 placeholders otherwise.
+static VkImage FrameImages[FramesInFlight];
+// the graphics queue's half of an AsyncCompute frame, per swapchain image and frame slot like CachedFrameCommands
+static VkCommandBuffer BlitCommands[MaxSwapchainImageCount * FramesInFlight];
+static u32 BlitCommandGenerations[MaxSwapchainImageCount * FramesInFlight];
+// When the surface allows storage swapchain images, the pass that shades the frame writes the acquired image
+// through its descriptor set (set 1) in place of the blit from OutputImage, which then only keeps the trails
+static bool PresentDirect = false;
+static bool StorageImageWriteWithoutFormat = false;
+static VkDescriptorSetLayout PresentDescriptorSetLayout;
+static VkDescriptorSet PresentDescriptorSets[MaxSwapchainImageCount];
+static VkImageView SwapchainImageViews[MaxSwapchainImageCount];
 
 enum {
 	BUFFER_IDX_UNIFORM,
 	BUFFER_IDX_POSITION,
 	BUFFER_IDX_ANGLE,
 	BUFFER_IDX_DENSITY_FIELD,
+	BUFFER_IDX_ROW_PREFIX_SUM,
+	BUFFER_IDX_BINS,
+	BUFFER_IDX_BINNED_PARTICLES,
+	BUFFER_IDX_PARTICLE_BIN_SLOTS,
+	BUFFER_IDX_REORDERED_POSITION,
+	BUFFER_IDX_REORDERED_ANGLE,
+	BUFFER_IDX_PARTICLE_ID,
+	BUFFER_IDX_REORDERED_PARTICLE_ID,
+	BUFFER_IDX_BINNED_POSITIONS,
+	BUFFER_IDX_FFT_LAYERS,
+	BUFFER_IDX_OCCUPANCY_BITMAP,
+	BUFFER_IDX_OCCUPANCY_OVERFLOW_FLAGS,
+	BUFFER_IDX_OCCUPANCY_OVERFLOW,
+	BUFFER_IDX_MOVED_FROM_CELLS,
+	BUFFER_IDX_NEIGHBOR_COUNTS,
+	BUFFER_IDX_REFRESH_ERRORS,
+	BUFFER_IDX_SINE_TABLE,
+	BUFFER_IDX_TRAIL_VISITS,
+	BUFFER_IDX_PARTICLE_COUNT,
 	BUFFER_IDX_COUNT
 };
 
 static VkDescriptorBufferInfo BufferHandles[BUFFER_IDX_COUNT] = {0};
 
+// The output image keeps only the channels that are drawn, red for the trails and green for the particles, in two
+// bytes per pixel, when the device can store to and blit from R8G8 images. The blit to the swapchain expands it with
+// blue 0 and alpha 1. Otherwise it falls back to four bytes per pixel. The shaders that access OutputImage have an
+// OUTPUT_IMAGE_RG8 build each, because the format qualifier in bindings.glsl.h has to match.
+static bool OutputImageRG8 = false;
+static VkFormat OutputImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
 struct uniform_data {
 	v2i ImageSize;
-	u32 ParticleCount;
-	u32 FrameNumber;
+	u32 FirstFrameNumber;
+	u32 PresentedFrameNumber;
 	u32 DensityBufferLength;
 	u32 DensityBufferWidth;
 	u32 DensityBufferHeight;
+	u32 FftWidth;
+	u32 FftHeight;
+	u32 OccupancyRowWords;
+	u32 OccupancyBitmapLength;
+	u32 IncrementalDensity;
+	u32 NeighborRefreshPeriod;
+	u32 NeighborRefreshAll;
+	u32 MeasureRefreshError;
+	u32 TrailTimestamps;
+	u32 SpawnCount;
+	u32 SpawnSeed;
+	f32 EditRegionX;
+	f32 EditRegionY;
+	f32 EditRegionRadius;
+};
+
+// mirrors ParticleCountBuffer in bindings.glsl.h; the first three words are a VkDispatchIndirectCommand
+struct particle_counter {
+	u32 DispatchX;
+	u32 DispatchY;
+	u32 DispatchZ;
+	u32 ParticleCount;
+	u32 PendingParticleCount;
+	u32 NextParticleId;
+	u32 TunedDispatchX;
+	u32 TunedDispatchY;
+	u32 TunedDispatchZ;
+};
+
+// mirrors SubstepConstants in bindings.glsl.h
+struct substep_constants {
+	u32 Substep;
+	u32 LastSubstep;
+};
+
+// mirrors RefreshErrorBuffer in bindings.glsl.h
+struct refresh_error_stats {
+	u32 CachedParticles;
+	u32 CountSum;
+	u32 MaxCount;
+	u32 WrongTurns;
+};
+
+enum {
+	PIPELINE_IDX_RESET,
+	PIPELINE_IDX_CLEAR,
+	PIPELINE_IDX_FADE,
+	PIPELINE_IDX_SIMULATE,
+	PIPELINE_IDX_RENDER_DENSITY_BUFFER,
+	PIPELINE_IDX_ROW_PREFIX_SUM,
+	PIPELINE_IDX_BIN_PARTICLES,
+	PIPELINE_IDX_SCAN_BINS,
+	PIPELINE_IDX_SCATTER_BINS,
+	PIPELINE_IDX_SIMULATE_TILED,
+	PIPELINE_IDX_BIN_PARTICLES_MORTON,
+	PIPELINE_IDX_SCAN_BINS_MORTON,
+	PIPELINE_IDX_REORDER_PARTICLES,
+	PIPELINE_IDX_BIN_PARTICLES_CELLS,
+	PIPELINE_IDX_SCAN_BINS_CELLS,
+	PIPELINE_IDX_SCATTER_BINS_CELLS,
+	PIPELINE_IDX_SIMULATE_CELL_LIST,
+	PIPELINE_IDX_FFT_LOAD,
+	PIPELINE_IDX_FFT_KERNELS,
+	PIPELINE_IDX_FFT_ROWS,
+	PIPELINE_IDX_FFT_COLUMNS,
+	PIPELINE_IDX_FFT_KERNEL_ROWS,
+	PIPELINE_IDX_FFT_KERNEL_COLUMNS,
+	PIPELINE_IDX_FFT_MULTIPLY,
+	PIPELINE_IDX_FFT_INVERSE_ROWS,
+	PIPELINE_IDX_FFT_INVERSE_COLUMNS,
+	PIPELINE_IDX_SIMULATE_FFT,
+	PIPELINE_IDX_RESET_BITMAP,
+	PIPELINE_IDX_SIMULATE_BITMAP,
+	PIPELINE_IDX_UPDATE_DENSITY,
+	PIPELINE_IDX_ROW_PREFIX_SUM_FUSED,
+	PIPELINE_IDX_PRESENT_TRAILS,
+	PIPELINE_IDX_SPAWN_PARTICLES,
+	PIPELINE_IDX_UPDATE_PARTICLE_COUNT,
+	PIPELINE_IDX_COMPACT_COUNT,
+	PIPELINE_IDX_COMPACT_SCAN,
+	PIPELINE_IDX_COMPACT_SCATTER,
+	PIPELINE_IDX_COUNT
+};
+
+static VkPipeline Pipelines[PIPELINE_IDX_COUNT];
+
+// Tunable parameters that are baked into the pipelines as specialization constants
+struct simulation_params {
+	u32 SearchRadiusSquared; // in density buffer cells
+	f32 Alpha; // degrees
+	f32 Beta; // degrees
+	u32 DensityBufferDownscale;
+};
+
+// Mirrors the constant_id layout in specialization.glsl.h: one 4 byte field per id, in id order
+struct specialization_data {
+	s32 SearchRadiusSquared;
+	f32 Alpha;
+	f32 Beta;
+	s32 DensityBufferDownscale;
+	s32 DiscRowCount;
+	s32 DiscHalfWidths[MAX_DISC_ROWS + 1];
+	s32 BinKey;
+	s32 CellListCellSize;
+	s32 FftAxis;
+	VkBool32 FftInverse;
+	s32 FftFirstLayer;
+	s32 FixedAlpha;
+	s32 FixedBeta;
+	s32 ParticleGroupSize;
+	s32 ImageGroupWidth;
+	s32 ImageGroupHeight;
+};
+static_assert(sizeof(specialization_data) == SPEC_ID_COUNT * sizeof(s32));
+
+// Workgroup shapes of the kernels the autotuner times. The best shape differs between devices, so it is measured once
+// per device and saved, see LoadWorkgroupTuning. Only the passes that were timed take the tuned shapes; the other
+// kernels with the same spec constants keep DefaultWorkgroupTuning, see SpecializationDataFor.
+struct workgroup_tuning {
+	u32 ParticleGroupSize; // the row prefix sum simulate kernel, one invocation per particle
+	u32 ImageGroupWidth; // the fade pass, one invocation per pixel
+	u32 ImageGroupHeight;
+};
+static constexpr workgroup_tuning DefaultWorkgroupTuning = { 128, 16, 16 };
+static workgroup_tuning WorkgroupTuning = DefaultWorkgroupTuning;
+static constexpr u32 ParticleGroupCandidates[] = { 32, 64, 128, 256, 512 };
+static constexpr v2i ImageGroupCandidates[] = { { 8, 8 }, { 16, 8 }, { 16, 16 }, { 32, 8 }, { 32, 16 }, { 64, 4 } };
+
+// How the simulate pass finds each particle's neighbors
+enum {
+	SIMULATION_ENGINE_ROW_PREFIX_SUM, // half-disc counts from prefix sums over the density field rows
+	SIMULATION_ENGINE_TILED, // particles binned by SIMULATE_TILE_SIZE tiles, each tile simulated against a shared memory copy of its neighborhood
+	SIMULATION_ENGINE_CELL_LIST, // exact distances to the particles of the 3x3 surrounding cells of a radius sized cell list
+	SIMULATION_ENGINE_FFT, // density field convolved with per orientation half-disc kernels, one fetch per particle
+	SIMULATION_ENGINE_BITMAP, // row prefix engine's half-disc rows counted with bitCount on a 1 bit per cell occupancy bitmap
+	SIMULATION_ENGINE_COUNT
+};
+
+static u32 SimulationEngine = SIMULATION_ENGINE_ROW_PREFIX_SUM;
+static const char *SimulationEngineNames[SIMULATION_ENGINE_COUNT] = {
+	"row prefix sums",
+	"tiled",
+	"cell list",
+	"FFT",
+	"occupancy bitmap",
+};
+
+// Size of each FftLayers layer: the density buffer plus its halo, rounded up to powers of two.
+// The layers are only allocated while the FFT engine is selected, and are 0 otherwise.
+static u32 FftWidth = 0;
+static u32 FftHeight = 0;
+// the kernel spectra depend on the radius and the layer size, so they are rebuilt after either changes
+static bool FftKernelsDirty = true;
+// Words per row and per half of the occupancy bitmap, which replaces the density field while the bitmap engine is selected.
+// Both are 0 otherwise, and DensityBufferLength is 0 while the bitmap engine is selected.
+static u32 OccupancyRowWords = 0;
+static u32 OccupancyBitmapLength = 0;
+static_assert(OCCUPANCY_OVERFLOW_CAPACITY >= MAX_PARTICLE_COUNT);
+// Keep a single density field that is updated by the particles that change cells, instead of clearing and
+// rebuilding one of two halves every frame. DensityFieldHalves follows it on the next allocation.
+static bool IncrementalDensity = false;
+static u32 DensityFieldHalves = 2;
+// Approximate mode of the row prefix engine: each frame only one in NeighborRefreshPeriod particles recounts its
+// neighbors and the rest reuse their cached counts. 1 is exact. The cache is stale after a reset or reorder,
+// or after another engine ran, and then every particle is recounted once.
+static u32 NeighborRefreshPeriod = 1;
+// The row prefix engine runs the FUSED_FADE build of its prefix pass, which clears the read half once it has been
+// consumed and fades the image, in place of the full-screen fade pass and its barriers. DensityReadHalfCleared is
+// set after such a frame: the next frame's write half is then already zero, otherwise it is filled first.
+// Off until the autotuner has timed it against the separate passes on this device, see FinishAutotune.
+static bool FuseClearAndFade = false;
+static bool DensityReadHalfCleared = false;
+// Trail mode: particles stamp the presented frame number into TrailVisits and the trails are computed from the stamps
+// once per presented frame, instead of fading every pixel of the image each frame.
+// TrailVisitLength follows it on the next allocation and is 0 while the buffer is not allocated.
+static bool TrailTimestamps = false;
+static u32 TrailVisitLength = 0;
+static bool NeighborCountsValid = false;
+// E compares the cached counts against exact ones for one frame and prints the result once that frame completes
+static bool RefreshErrorRequested = false;
+static bool RefreshErrorPending = false;
+// FrameTimeline value of the frame that measures the error
+static u64 RefreshErrorTimelineValue = 0;
+
+// A steady frame (no reset, spawn, reorder, kernel rebuild or autotuning) records the same commands every time for a
+// given swapchain image and frame slot, so those are recorded once and resubmitted. Without fast-forward, CurrentFrame
+// and FrameNumber advance together, so the parity in the key only changes after a swapchain rebuild.
+// the parameters of a steady frame that are chosen per frame; everything else is covered by FrameCommandsGeneration
+struct frame_commands_key {
+	u32 Generation;
+	u32 Engine;
+	u32 FusedFade;
+	u32 FadeNeeded;
+	u32 ClearWriteHalf;
+	u32 SubstepCount;
+	u32 FrameParity;
+};
+// bumped whenever the buffers, images, pipelines or workgroup sizes that recorded commands refer to are replaced
+static u32 FrameCommandsGeneration = 1;
+// indexed by ImageIndex * FramesInFlight + CurrentFrame; a zero Generation marks a command buffer never recorded
+static VkCommandBuffer CachedFrameCommands[MaxSwapchainImageCount * FramesInFlight];
+static frame_commands_key CachedFrameKeys[MaxSwapchainImageCount * FramesInFlight];
+// First quadrant of sin for FIXED_POINT_MOTION, computed once on the host so every device steers by the same table
+static s32 SineTable[1 << SINE_TABLE_BITS];
+static_assert(sizeof(SineTable) <= 65536, "the sine table is uploaded with a single vkCmdUpdateBuffer");
+static u32 MaxComputeSharedMemorySize = 0;
+static u32 MaxComputeWorkGroupInvocations = 0;
+static u32 MaxStorageBufferRange = 0;
+
+// Use the SUBGROUP_DEPOSIT builds of the depositing shaders, which need Vulkan 1.1 and subgroup ballots in compute
+static bool SubgroupDeposit = false;
+static u32 TileCountX = 0;
+static u32 TileCountY = 0;
+
+// Every ReorderInterval frames the particle buffers are sorted along a Z-order curve, so particles that are
+// close on screen are also close in memory when the simulate kernels gather and deposit
+static bool ReorderParticles = true;
+static u32 ReorderInterval = 256;
+
+static simulation_params SimulationParams = { 128, 5.0f, 12.0f, DENSITY_BUFFER_DOWNSCALE };
+
+// Everything a pipeline variant is built from. The worker thread gets a copy, so the main thread is free to change
+// the globals while it runs.
+struct pipeline_build_job {
+	simulation_params Params;
+	workgroup_tuning Tuning;
+	bool SubgroupDeposit;
+	bool PresentDirect;
+	bool OutputImageRG8;
 };
+static simulation_params RequestedSimulationParams = SimulationParams;
 
-static VkPipeline ClearComputePipeline;
-static VkPipeline ResetComputePipeline;
-static VkPipeline FadeComputePipeline;
-static VkPipeline SimulateComputePipeline;
-static VkPipeline RenderDensityBufferComputePipeline;
+// Variants are compiled on a worker thread while the current pipelines keep running
+static pipeline_build_job PendingBuildJob;
+static VkPipeline PendingPipelines[PIPELINE_IDX_COUNT];
+static std::thread PipelineBuildThread;
+static std::atomic<bool> PipelineBuildFinished;
+static bool PipelineBuildSucceeded;
 
 static VkDescriptorPool DescriptorPool;
 
@@ -88,6 +405,195 @@ static u32 SimulateComputeShader[] =
 static u32 RenderDensityBufferComputeShader[] =
 	#include "render_density_buffer.compute.h"
 ;
+static u32 RowPrefixSumComputeShader[] =
+	#include "row_prefix_sum.compute.h"
+;
+static u32 BinParticlesComputeShader[] =
+	#include "bin_particles.compute.h"
+;
+static u32 ScanBinsComputeShader[] =
+	#include "scan_bins.compute.h"
+;
+static u32 ScatterBinsComputeShader[] =
+	#include "scatter_bins.compute.h"
+;
+static u32 SimulateTiledComputeShader[] =
+	#include "simulate_tiled.compute.h"
+;
+static u32 ReorderParticlesComputeShader[] =
+	#include "reorder_particles.compute.h"
+;
+static u32 SimulateCellListComputeShader[] =
+	#include "simulate_cell_list.compute.h"
+;
+static u32 FftLoadComputeShader[] =
+	#include "fft_load.compute.h"
+;
+static u32 FftKernelsComputeShader[] =
+	#include "fft_kernels.compute.h"
+;
+static u32 FftLinesComputeShader[] =
+	#include "fft_lines.compute.h"
+;
+static u32 FftMultiplyComputeShader[] =
+	#include "fft_multiply.compute.h"
+;
+static u32 SimulateFftComputeShader[] =
+	#include "simulate_fft.compute.h"
+;
+static u32 ResetBitmapComputeShader[] =
+	#include "reset_bitmap.compute.h"
+;
+static u32 SimulateBitmapComputeShader[] =
+	#include "simulate_bitmap.compute.h"
+;
+static u32 UpdateDensityComputeShader[] =
+	#include "update_density.compute.h"
+;
+static u32 RowPrefixSumFusedComputeShader[] =
+	#include "row_prefix_sum_fused.compute.h"
+;
+static u32 PresentTrailsComputeShader[] =
+	#include "present_trails.compute.h"
+;
+static u32 SpawnParticlesComputeShader[] =
+	#include "spawn_particles.compute.h"
+;
+static u32 UpdateParticleCountComputeShader[] =
+	#include "update_particle_count.compute.h"
+;
+static u32 CompactCountComputeShader[] =
+	#include "compact_count.compute.h"
+;
+static u32 CompactScanComputeShader[] =
+	#include "compact_scan.compute.h"
+;
+static u32 CompactScatterComputeShader[] =
+	#include "compact_scatter.compute.h"
+;
+
+// PRESENT_DIRECT builds of the shaders that write the finished image
+static u32 FadeDirectComputeShader[] =
+	#include "fade_direct.compute.h"
+;
+static u32 RowPrefixSumFusedDirectComputeShader[] =
+	#include "row_prefix_sum_fused_direct.compute.h"
+;
+static u32 PresentTrailsDirectComputeShader[] =
+	#include "present_trails_direct.compute.h"
+;
+
+// OUTPUT_IMAGE_RG8 builds of the shaders that access OutputImage
+static u32 ClearRG8ComputeShader[] =
+	#include "clear_rg8.compute.h"
+;
+static u32 FadeRG8ComputeShader[] =
+	#include "fade_rg8.compute.h"
+;
+static u32 RenderDensityBufferRG8ComputeShader[] =
+	#include "render_density_buffer_rg8.compute.h"
+;
+static u32 RowPrefixSumFusedRG8ComputeShader[] =
+	#include "row_prefix_sum_fused_rg8.compute.h"
+;
+static u32 PresentTrailsRG8ComputeShader[] =
+	#include "present_trails_rg8.compute.h"
+;
+static u32 FadeDirectRG8ComputeShader[] =
+	#include "fade_direct_rg8.compute.h"
+;
+static u32 RowPrefixSumFusedDirectRG8ComputeShader[] =
+	#include "row_prefix_sum_fused_direct_rg8.compute.h"
+;
+
+// SUBGROUP_DEPOSIT builds of the shaders that deposit into the density field
+static u32 ResetSubgroupComputeShader[] =
+	#include "reset_subgroup.compute.h"
+;
+static u32 SimulateSubgroupComputeShader[] =
+	#include "simulate_subgroup.compute.h"
+;
+static u32 SimulateTiledSubgroupComputeShader[] =
+	#include "simulate_tiled_subgroup.compute.h"
+;
+static u32 SimulateCellListSubgroupComputeShader[] =
+	#include "simulate_cell_list_subgroup.compute.h"
+;
+
+// indexed by PIPELINE_IDX_*
+static const range<u32> ComputeShaders[PIPELINE_IDX_COUNT] = {
+	CreateRange(ResetComputeShader),
+	CreateRange(ClearComputeShader),
+	CreateRange(FadeComputeShader),
+	CreateRange(SimulateComputeShader),
+	CreateRange(RenderDensityBufferComputeShader),
+	CreateRange(RowPrefixSumComputeShader),
+	CreateRange(BinParticlesComputeShader),
+	CreateRange(ScanBinsComputeShader),
+	CreateRange(ScatterBinsComputeShader),
+	CreateRange(SimulateTiledComputeShader),
+	CreateRange(BinParticlesComputeShader),
+	CreateRange(ScanBinsComputeShader),
+	CreateRange(ReorderParticlesComputeShader),
+	CreateRange(BinParticlesComputeShader),
+	CreateRange(ScanBinsComputeShader),
+	CreateRange(ScatterBinsComputeShader),
+	CreateRange(SimulateCellListComputeShader),
+	CreateRange(FftLoadComputeShader),
+	CreateRange(FftKernelsComputeShader),
+	CreateRange(FftLinesComputeShader),
+	CreateRange(FftLinesComputeShader),
+	CreateRange(FftLinesComputeShader),
+	CreateRange(FftLinesComputeShader),
+	CreateRange(FftMultiplyComputeShader),
+	CreateRange(FftLinesComputeShader),
+	CreateRange(FftLinesComputeShader),
+	CreateRange(SimulateFftComputeShader),
+	CreateRange(ResetBitmapComputeShader),
+	CreateRange(SimulateBitmapComputeShader),
+	CreateRange(UpdateDensityComputeShader),
+	CreateRange(RowPrefixSumFusedComputeShader),
+	CreateRange(PresentTrailsComputeShader),
+	CreateRange(SpawnParticlesComputeShader),
+	CreateRange(UpdateParticleCountComputeShader),
+	CreateRange(CompactCountComputeShader),
+	CreateRange(CompactScanComputeShader),
+	CreateRange(CompactScatterComputeShader),
+};
+
+static range<u32> ComputeShaderFor(u32 PipelineIndex, bool UseSubgroupDeposit, bool UsePresentDirect, bool UseOutputRG8) {
+	if (UsePresentDirect && UseOutputRG8) {
+		switch (PipelineIndex) {
+			case PIPELINE_IDX_FADE: return CreateRange(FadeDirectRG8ComputeShader);
+			case PIPELINE_IDX_ROW_PREFIX_SUM_FUSED: return CreateRange(RowPrefixSumFusedDirectRG8ComputeShader);
+		}
+	}
+	if (UsePresentDirect) {
+		switch (PipelineIndex) {
+			case PIPELINE_IDX_FADE: return CreateRange(FadeDirectComputeShader);
+			case PIPELINE_IDX_ROW_PREFIX_SUM_FUSED: return CreateRange(RowPrefixSumFusedDirectComputeShader);
+			case PIPELINE_IDX_PRESENT_TRAILS: return CreateRange(PresentTrailsDirectComputeShader);
+		}
+	}
+	if (UseOutputRG8) {
+		switch (PipelineIndex) {
+			case PIPELINE_IDX_CLEAR: return CreateRange(ClearRG8ComputeShader);
+			case PIPELINE_IDX_FADE: return CreateRange(FadeRG8ComputeShader);
+			case PIPELINE_IDX_RENDER_DENSITY_BUFFER: return CreateRange(RenderDensityBufferRG8ComputeShader);
+			case PIPELINE_IDX_ROW_PREFIX_SUM_FUSED: return CreateRange(RowPrefixSumFusedRG8ComputeShader);
+			case PIPELINE_IDX_PRESENT_TRAILS: return CreateRange(PresentTrailsRG8ComputeShader);
+		}
+	}
+	if (UseSubgroupDeposit) {
+		switch (PipelineIndex) {
+			case PIPELINE_IDX_RESET: return CreateRange(ResetSubgroupComputeShader);
+			case PIPELINE_IDX_SIMULATE: return CreateRange(SimulateSubgroupComputeShader);
+			case PIPELINE_IDX_SIMULATE_TILED: return CreateRange(SimulateTiledSubgroupComputeShader);
+			case PIPELINE_IDX_SIMULATE_CELL_LIST: return CreateRange(SimulateCellListSubgroupComputeShader);
+		}
+	}
+	return ComputeShaders[PipelineIndex];
+}
 
 #define OnExitPush(...) {\
 	static auto Task = [](){ __VA_ARGS__; };\
@@ -120,14 +626,238 @@ static inline s32 S32_Max(s32 A, s32 B) {
 	return (A > B) ? A : B;
 }
 static inline s32 S32_Min(s32 A, s32 B) {
-	return (A > B) ? A : B;
+	return (A < B) ? A : B;
 }
 static inline s32 S32_Clamp(s32 A, s32 Min, s32 Max) {
 	return S32_Min(S32_Max(A, Min), Max);
 }
 
-static vulkan_arena<4> GPULocalArena;
-static vulkan_arena<1> GPUVisibleArena;
+// only the simulate kernels and the cell list passes read the sensing constants; the other pipelines stay cached across retunes
+static bool PipelineUsesSensingConstants(u32 PipelineIndex) {
+	switch (PipelineIndex) {
+		case PIPELINE_IDX_SIMULATE:
+		case PIPELINE_IDX_SIMULATE_TILED:
+		case PIPELINE_IDX_BIN_PARTICLES_CELLS:
+		case PIPELINE_IDX_SCAN_BINS_CELLS:
+		case PIPELINE_IDX_SCATTER_BINS_CELLS:
+		case PIPELINE_IDX_SIMULATE_CELL_LIST:
+		case PIPELINE_IDX_FFT_KERNELS:
+		case PIPELINE_IDX_SIMULATE_FFT:
+		case PIPELINE_IDX_SIMULATE_BITMAP:
+			return true;
+	}
+	return false;
+}
+
+// fft_lines is specialized per use: which axis, which direction and which layers it transforms
+static void SetFftLineConstants(u32 PipelineIndex, specialization_data *Data) {
+	switch (PipelineIndex) {
+		case PIPELINE_IDX_FFT_ROWS:
+		case PIPELINE_IDX_FFT_COLUMNS: {
+			Data->FftFirstLayer = 0;
+		} break;
+		case PIPELINE_IDX_FFT_KERNEL_ROWS:
+		case PIPELINE_IDX_FFT_KERNEL_COLUMNS: {
+			Data->FftFirstLayer = FFT_FIRST_KERNEL_LAYER;
+		} break;
+		case PIPELINE_IDX_FFT_INVERSE_ROWS:
+		case PIPELINE_IDX_FFT_INVERSE_COLUMNS: {
+			Data->FftFirstLayer = FFT_FIRST_RESPONSE_LAYER;
+			Data->FftInverse = VK_TRUE;
+		} break;
+		default: return;
+	}
+	bool Columns = PipelineIndex == PIPELINE_IDX_FFT_COLUMNS ||
+		PipelineIndex == PIPELINE_IDX_FFT_KERNEL_COLUMNS ||
+		PipelineIndex == PIPELINE_IDX_FFT_INVERSE_COLUMNS;
+	Data->FftAxis = Columns ? 1 : 0;
+}
+
+// the binning shaders are shared by the tiled simulate kernel, the reorder pass and the cell list, which bin by different keys
+static s32 PipelineBinKey(u32 PipelineIndex) {
+	switch (PipelineIndex) {
+		case PIPELINE_IDX_BIN_PARTICLES_MORTON:
+		case PIPELINE_IDX_SCAN_BINS_MORTON:
+		case PIPELINE_IDX_REORDER_PARTICLES:
+			return BIN_KEY_MORTON;
+		case PIPELINE_IDX_BIN_PARTICLES_CELLS:
+		case PIPELINE_IDX_SCAN_BINS_CELLS:
+		case PIPELINE_IDX_SCATTER_BINS_CELLS:
+		case PIPELINE_IDX_SIMULATE_CELL_LIST:
+			return BIN_KEY_CELL;
+	}
+	return BIN_KEY_TILE;
+}
+
+static u32 RoundUpToPowerOfTwo(u32 Value) {
+	u32 Result = 1;
+	while (Result < Value) {
+		Result <<= 1;
+	}
+	return Result;
+}
+
+// index bits a side of Size cells takes in the Z-order layout: 0 for a single cell, otherwise those of Size
+// rounded up to a power of two
+static u32 MortonBits(u32 Size) {
+	u32 Bits = 0;
+	while ((1u << Bits) < Size) {
+		Bits += 1;
+	}
+	return Bits;
+}
+
+// Cells in each half of DensityField, including the padding of the layout chosen by DENSITY_LAYOUT.
+// Mirrors density_index in bindings.glsl.h.
+static u32 DensityFieldLength(u32 Width, u32 Height) {
+#if DENSITY_LAYOUT == DENSITY_LAYOUT_BLOCKED
+	u32 BlocksX = (Width + DENSITY_BLOCK_SIZE - 1) / DENSITY_BLOCK_SIZE;
+	u32 BlocksY = (Height + DENSITY_BLOCK_SIZE - 1) / DENSITY_BLOCK_SIZE;
+	return BlocksX * BlocksY * DENSITY_BLOCK_SIZE * DENSITY_BLOCK_SIZE;
+#elif DENSITY_LAYOUT == DENSITY_LAYOUT_MORTON
+	u32 Bits = MortonBits(Width) + MortonBits(Height);
+	RuntimeAssert(Bits < 32);
+	return 1u << Bits;
+#else
+	return Width * Height;
+#endif
+}
+
+// words in each half of OccupancyOverflowFlags: one bit per occupancy bitmap word, mirrors occupancy_flag_words
+static u32 OccupancyFlagWordCount() {
+	return (OccupancyBitmapLength + 31) / 32;
+}
+
+// shared memory used by simulate_tiled.compute.glsl: the tile plus a DiscRowCount wide halo on every side
+static u32 TiledSimulationSharedMemorySize(s32 DiscRowCount) {
+	u32 TileSpan = SIMULATE_TILE_SIZE + 2 * DiscRowCount;
+	return TileSpan * TileSpan * sizeof(u32);
+}
+
+// The specialization constants of pipeline PipelineIndex for the simulation parameters and workgroup shapes
+static specialization_data SpecializationDataFor(const simulation_params &Params, const workgroup_tuning &Tuning, u32 PipelineIndex) {
+	specialization_data Data = {};
+	Data.DensityBufferDownscale = Params.DensityBufferDownscale;
+	Data.BinKey = PipelineBinKey(PipelineIndex);
+	SetFftLineConstants(PipelineIndex, &Data);
+	// update_particle_count sizes the simulate kernel's dispatch, so it takes the same group size
+	bool TunedParticleGroup = PipelineIndex == PIPELINE_IDX_SIMULATE || PipelineIndex == PIPELINE_IDX_UPDATE_PARTICLE_COUNT;
+	Data.ParticleGroupSize = TunedParticleGroup ? Tuning.ParticleGroupSize : DefaultWorkgroupTuning.ParticleGroupSize;
+	bool TunedImageGroup = PipelineIndex == PIPELINE_IDX_FADE;
+	Data.ImageGroupWidth = TunedImageGroup ? Tuning.ImageGroupWidth : DefaultWorkgroupTuning.ImageGroupWidth;
+	Data.ImageGroupHeight = TunedImageGroup ? Tuning.ImageGroupHeight : DefaultWorkgroupTuning.ImageGroupHeight;
+	if (!PipelineUsesSensingConstants(PipelineIndex)) {
+		return Data;
+	}
+
+	Data.SearchRadiusSquared = Params.SearchRadiusSquared;
+	Data.Alpha = Params.Alpha;
+	Data.Beta = Params.Beta;
+	Data.DiscRowCount = 0;
+	for (s32 y = 0; y <= MAX_DISC_ROWS; ++y) {
+		s32 HalfWidth = -1;
+		while ((HalfWidth + 1) * (HalfWidth + 1) + y * y <= (s32)Params.SearchRadiusSquared) {
+			HalfWidth += 1;
+		}
+		Data.DiscHalfWidths[y] = HalfWidth;
+		if (HalfWidth >= 0) {
+			Data.DiscRowCount = y;
+		}
+	}
+
+	// cells at least one sensing radius wide (in pixels), so the 3x3 cells around a particle cover its disc
+	s32 Radius = 0;
+	while (Radius * Radius < (s32)Params.SearchRadiusSquared) {
+		Radius += 1;
+	}
+	Data.CellListCellSize = S32_Max(Radius * Params.DensityBufferDownscale, CELL_LIST_MIN_CELL_SIZE);
+
+	// binary angle units for FIXED_POINT_MOTION
+	const f64 UnitsPerDegree = (f64)(1 << FIXED_ANGLE_BITS) / 360.0;
+	Data.FixedAlpha = (s32)lround(Params.Alpha * UnitsPerDegree);
+	Data.FixedBeta = (s32)lround(Params.Beta * UnitsPerDegree);
+	return Data;
+}
+
+// a job for Params with the current workgroup sizes and shader builds
+static pipeline_build_job PipelineBuildJobFor(const simulation_params &Params) {
+	return { Params, WorkgroupTuning, SubgroupDeposit, PresentDirect, OutputImageRG8 };
+}
+
+static VkPipeline CreateSpecializedPipeline(const pipeline_build_job &Job, u32 PipelineIndex, const specialization_data &Data) {
+	VkSpecializationMapEntry MapEntries[SPEC_ID_COUNT];
+	for (u32 i = 0; i < SPEC_ID_COUNT; ++i) {
+		MapEntries[i] = { i, (u32)(i * sizeof(s32)), sizeof(s32) };
+	}
+
+	VkSpecializationInfo SpecializationInfo = {
+		.mapEntryCount = ArrayLen(MapEntries),
+		.pMapEntries = MapEntries,
+		.dataSize = sizeof(specialization_data),
+		.pData = &Data
+	};
+	return VulkanCreateComputeShaderPipeline(ComputeShaderFor(PipelineIndex, Job.SubgroupDeposit, Job.PresentDirect, Job.OutputImageRG8), PipelineLayout, &SpecializationInfo);
+}
+
+// Gives a variant's pipelines back to the cache; RetireValue is the last frame timeline value that may still use them
+static void ReleasePipelineVariant(VkPipeline *Variant, u64 RetireValue) {
+	for (u32 i = 0; i < PIPELINE_IDX_COUNT; ++i) {
+		VulkanReleaseComputePipeline(Variant[i], RetireValue);
+		Variant[i] = VK_NULL_HANDLE;
+	}
+}
+
+// Returns false, with nothing held, when a pipeline fails to build or the pipeline cache is full
+static bool BuildPipelineVariant(const pipeline_build_job &Job, VkPipeline *Result) {
+	for (u32 i = 0; i < PIPELINE_IDX_COUNT; ++i) {
+		Result[i] = VK_NULL_HANDLE;
+	}
+	for (u32 i = 0; i < PIPELINE_IDX_COUNT; ++i) {
+		specialization_data Data = SpecializationDataFor(Job.Params, Job.Tuning, i);
+		if (i == PIPELINE_IDX_SIMULATE_TILED && TiledSimulationSharedMemorySize(Data.DiscRowCount) > MaxComputeSharedMemorySize) {
+			continue;
+		}
+		if (i == PIPELINE_IDX_ROW_PREFIX_SUM_FUSED && FUSED_FADE_SLICES * 128 > MaxComputeWorkGroupInvocations) {
+			continue;
+		}
+		Result[i] = CreateSpecializedPipeline(Job, i, Data);
+		if (!Result[i]) {
+			// none of them were ever bound
+			ReleasePipelineVariant(Result, 0);
+			return false;
+		}
+	}
+	return true;
+}
+
+static void PrintSimulationParams(const simulation_params &Params) {
+	printf("search radius^2: %u, alpha: %.1f, beta: %.1f, density buffer downscale: %u\n",
+		Params.SearchRadiusSquared, Params.Alpha, Params.Beta, Params.DensityBufferDownscale);
+}
+
+// every buffer but the uniform buffer and the refresh error stats, plus the output image and the frame images
+static constexpr u32 GPULocalArenaHandleCount = BUFFER_IDX_COUNT - 1 + FramesInFlight;
+static vulkan_arena<GPULocalArenaHandleCount> GPULocalArena;
+// the uniform buffer, then the refresh error stats
+static vulkan_arena<2> GPUVisibleArena;
+// GPUVisibleArena is mapped once at startup and stays mapped until exit
+static u8 *GPUVisibleMapping = NULL;
+
+// what the host last wrote to each frame's uniform slice; a frame only writes the words that changed since then
+static uniform_data UniformSliceContents[FramesInFlight];
+
+static void WriteUniformSlice(u32 Frame, const uniform_data &Data) {
+	static_assert(sizeof(uniform_data) % sizeof(u32) == 0, "uniform_data is compared word by word");
+	const u32 *Source = (const u32 *)&Data;
+	u32 *Previous = (u32 *)&UniformSliceContents[Frame];
+	u32 *Slice = (u32 *)(GPUVisibleMapping + GPUVisibleArena.MemoryHandles[0].Offset + Frame * UniformStride);
+	for (u32 i = 0; i < sizeof(uniform_data) / sizeof(u32); ++i) {
+		if (Source[i] != Previous[i]) {
+			Slice[i] = Source[i];
+			Previous[i] = Source[i];
+		}
+	}
+}
 
 static void UpdateDescriptorSets() {
 
@@ -135,59 +865,74 @@ static void UpdateDescriptorSets() {
 	ImageInfo.imageView = OutputImageView;
 	ImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 
-	VkWriteDescriptorSet ImageUpdate = {};
-	ImageUpdate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	ImageUpdate.dstSet = DescriptorSet;
-	ImageUpdate.dstBinding = 0;
-	ImageUpdate.dstArrayElement = 0;
-	ImageUpdate.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-	ImageUpdate.descriptorCount = 1;
-	ImageUpdate.pImageInfo = &ImageInfo;
-
-	VkWriteDescriptorSet UniformBufferUpdate = {};
-	UniformBufferUpdate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	UniformBufferUpdate.dstSet = DescriptorSet;
-	UniformBufferUpdate.dstBinding = 1;
-	UniformBufferUpdate.dstArrayElement = 0;
-	UniformBufferUpdate.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	UniformBufferUpdate.descriptorCount = 1;
-	UniformBufferUpdate.pBufferInfo = &BufferHandles[BUFFER_IDX_UNIFORM];
-
-	VkWriteDescriptorSet PositionBufferUpdate = {};
-	PositionBufferUpdate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	PositionBufferUpdate.dstSet = DescriptorSet;
-	PositionBufferUpdate.dstBinding = 2;
-	PositionBufferUpdate.dstArrayElement = 0;
-	PositionBufferUpdate.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	PositionBufferUpdate.descriptorCount = 1;
-	PositionBufferUpdate.pBufferInfo = &BufferHandles[BUFFER_IDX_POSITION];
-
-	VkWriteDescriptorSet AngleBufferUpdate = {};
-	AngleBufferUpdate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	AngleBufferUpdate.dstSet = DescriptorSet;
-	AngleBufferUpdate.dstBinding = 3;
-	AngleBufferUpdate.dstArrayElement = 0;
-	AngleBufferUpdate.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	AngleBufferUpdate.descriptorCount = 1;
-	AngleBufferUpdate.pBufferInfo = &BufferHandles[BUFFER_IDX_ANGLE];
-
-	VkWriteDescriptorSet DensityFieldBufferUpdate = {};
-	DensityFieldBufferUpdate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	DensityFieldBufferUpdate.dstSet = DescriptorSet;
-	DensityFieldBufferUpdate.dstBinding = 4;
-	DensityFieldBufferUpdate.dstArrayElement = 0;
-	DensityFieldBufferUpdate.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	DensityFieldBufferUpdate.descriptorCount = 1;
-	DensityFieldBufferUpdate.pBufferInfo = &BufferHandles[BUFFER_IDX_DENSITY_FIELD];
-
-	VkWriteDescriptorSet DescriptorWrites[] = {
-		ImageUpdate,
-		UniformBufferUpdate,
-		PositionBufferUpdate,
-		AngleBufferUpdate,
-		DensityFieldBufferUpdate,
-	};
-	vkUpdateDescriptorSets(Device, ArrayLen(DescriptorWrites), DescriptorWrites, 0, NULL);
+	for (u32 Frame = 0; Frame < FramesInFlight; ++Frame) {
+		VkWriteDescriptorSet ImageUpdate = {};
+		ImageUpdate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		ImageUpdate.dstSet = DescriptorSets[Frame];
+		ImageUpdate.dstBinding = 0;
+		ImageUpdate.dstArrayElement = 0;
+		ImageUpdate.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		ImageUpdate.descriptorCount = 1;
+		ImageUpdate.pImageInfo = &ImageInfo;
+
+		VkDescriptorBufferInfo UniformSlice = BufferHandles[BUFFER_IDX_UNIFORM];
+		UniformSlice.offset = Frame * UniformStride;
+		UniformSlice.range = sizeof(uniform_data);
+
+		// buffer BUFFER_IDX_* is bound at binding BUFFER_IDX_* + 1, after the output image
+		VkWriteDescriptorSet DescriptorWrites[1 + BUFFER_IDX_COUNT] = { ImageUpdate };
+		for (u32 i = 0; i < BUFFER_IDX_COUNT; ++i) {
+			VkWriteDescriptorSet &BufferUpdate = DescriptorWrites[1 + i];
+			BufferUpdate.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			BufferUpdate.dstSet = DescriptorSets[Frame];
+			BufferUpdate.dstBinding = 1 + i;
+			BufferUpdate.dstArrayElement = 0;
+			BufferUpdate.descriptorType = (i == BUFFER_IDX_UNIFORM) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			BufferUpdate.descriptorCount = 1;
+			BufferUpdate.pBufferInfo = (i == BUFFER_IDX_UNIFORM) ? &UniformSlice : &BufferHandles[i];
+		}
+		vkUpdateDescriptorSets(Device, ArrayLen(DescriptorWrites), DescriptorWrites, 0, NULL);
+	}
+}
+
+static void DestroySwapchainImageViews() {
+	for (u32 i = 0; i < MaxSwapchainImageCount; ++i) {
+		if (SwapchainImageViews[i]) {
+			vkDestroyImageView(Device, SwapchainImageViews[i], NULL);
+			SwapchainImageViews[i] = VK_NULL_HANDLE;
+		}
+	}
+}
+
+// Points each swapchain image's descriptor set at a new view of the image
+static void UpdatePresentDescriptorSets(VkFormat Format) {
+	VkDescriptorImageInfo ImageInfos[MaxSwapchainImageCount] = {};
+	VkWriteDescriptorSet DescriptorWrites[MaxSwapchainImageCount] = {};
+	for (u32 i = 0; i < SwapchainImageCount; ++i) {
+		VkImageViewCreateInfo ImageViewCreateInfo = {};
+		ImageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		ImageViewCreateInfo.image = SwapchainImages[i];
+		ImageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		ImageViewCreateInfo.format = Format;
+		ImageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		ImageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+		ImageViewCreateInfo.subresourceRange.levelCount = 1;
+		ImageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+		ImageViewCreateInfo.subresourceRange.layerCount = 1;
+		RuntimeAssert(vkCreateImageView(Device, &ImageViewCreateInfo, NULL, &SwapchainImageViews[i]) == VK_SUCCESS);
+
+		ImageInfos[i].imageView = SwapchainImageViews[i];
+		ImageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		DescriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		DescriptorWrites[i].dstSet = PresentDescriptorSets[i];
+		DescriptorWrites[i].dstBinding = 0;
+		DescriptorWrites[i].dstArrayElement = 0;
+		DescriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		DescriptorWrites[i].descriptorCount = 1;
+		DescriptorWrites[i].pImageInfo = ImageInfos + i;
+	}
+	vkUpdateDescriptorSets(Device, SwapchainImageCount, DescriptorWrites, 0, NULL);
 }
 
 static void CreateSwapchain() {
@@ -200,32 +945,109 @@ static void CreateSwapchain() {
 	s32 Height = S32_Clamp(WindowHeight, Capabilities.minImageExtent.height, Capabilities.maxImageExtent.height);
 
 	vk_format_and_color FormatAndColor = VulkanGetBestAvailableFormatAndColor(PhysicalDevice, Surface);
+	DestroySwapchainImageViews();
 	vkDestroySwapchainKHR(Device, Swapchain, NULL);
-	Swapchain = VulkanCreateSwapchain(Device, Surface, FormatAndColor, { Width, Height });
+	Swapchain = VulkanCreateSwapchain(Device, Surface, FormatAndColor, { Width, Height }, PresentDirect ? VK_IMAGE_USAGE_STORAGE_BIT : 0);
 
 	vkGetSwapchainImagesKHR(Device, Swapchain, &SwapchainImageCount, NULL);
 	RuntimeAssert(SwapchainImageCount <= MaxSwapchainImageCount && SwapchainImageCount > 0);
 	RuntimeAssert(vkGetSwapchainImagesKHR(Device, Swapchain, &SwapchainImageCount, SwapchainImages) == VK_SUCCESS);
+	if (PresentDirect) {
+		UpdatePresentDescriptorSets(FormatAndColor.Format);
+	}
 
-	const VkFormat ImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	const VkFormat ImageFormat = OutputImageFormat;
 	VkPhysicalDeviceMemoryProperties DeviceProperties;
 	vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &DeviceProperties);
 
 	GPULocalArena.Destroy(Device);
 	{
-		auto ArenaBuilder = StartBuildingMemoryArena<4>(Device);
-		BufferHandles[BUFFER_IDX_POSITION].buffer = ArenaBuilder.PushBuffer(sizeof(v2) * MaxParticleCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
-		BufferHandles[BUFFER_IDX_ANGLE].buffer = ArenaBuilder.PushBuffer(sizeof(f32) * MaxParticleCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
-
-		constexpr u32 Downscale = DENSITY_BUFFER_DOWNSCALE;
+		auto ArenaBuilder = StartBuildingMemoryArena<GPULocalArenaHandleCount>(Device);
+		// the particle buffers are transfer destinations for the copy back after a reorder
+		const VkBufferUsageFlags ParticleBufferUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		const VkBufferUsageFlags ReorderedBufferUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		u32 ParticleIdCount = TRACK_PARTICLE_IDS ? MaxParticleCount : 1;
+		// packed particles keep x, y and the heading in one 8 byte element of the position buffer
+		u32 AngleCount = PACKED_PARTICLES ? 1 : MaxParticleCount;
+		BufferHandles[BUFFER_IDX_POSITION].buffer = ArenaBuilder.PushBuffer(ParticleElementSize * MaxParticleCount, ParticleBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_ANGLE].buffer = ArenaBuilder.PushBuffer(sizeof(f32) * AngleCount, ParticleBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_PARTICLE_ID].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * ParticleIdCount, ParticleBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_REORDERED_POSITION].buffer = ArenaBuilder.PushBuffer(ParticleElementSize * MaxParticleCount, ReorderedBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_REORDERED_ANGLE].buffer = ArenaBuilder.PushBuffer(sizeof(f32) * AngleCount, ReorderedBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_REORDERED_PARTICLE_ID].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * ParticleIdCount, ReorderedBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+
+		u32 Downscale = SimulationParams.DensityBufferDownscale;
 		u32 Width = (WindowWidth + Downscale - 1) / Downscale;
 		u32 Height = (WindowHeight + Downscale - 1) / Downscale;
-		DensityBufferLength = Width * Height;
 		DensityBufferWidth = Width;
 		DensityBufferHeight = Height;
-		BufferHandles[BUFFER_IDX_DENSITY_FIELD].buffer = ArenaBuilder.PushBuffer(2 * sizeof(u32) * DensityBufferLength, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+
+		// the bitmap engine swaps the density field and its row prefix sums for the occupancy buffers;
+		// the descriptors still need a buffer for whichever side is unused
+		bool UseBitmap = SimulationEngine == SIMULATION_ENGINE_BITMAP;
+		DensityBufferLength = UseBitmap ? 0 : DensityFieldLength(Width, Height);
+		OccupancyRowWords = UseBitmap ? (Width + 31) / 32 : 0;
+		OccupancyBitmapLength = OccupancyRowWords * Height;
+		DensityFieldHalves = IncrementalDensity ? 1 : 2;
+		u32 DensityFieldCount = UseBitmap ? 1 : DensityFieldHalves * DensityBufferLength;
+		u32 RowPrefixSumCount = UseBitmap ? 1 : DensityBufferLength;
+		u32 OccupancyBitmapCount = UseBitmap ? 2 * OccupancyBitmapLength : 1;
+		u32 OverflowFlagCount = UseBitmap ? 2 * OccupancyFlagWordCount() : 1;
+		u32 OverflowCount = UseBitmap ? 2 * 2 * OCCUPANCY_OVERFLOW_CAPACITY : 1;
+		const VkBufferUsageFlags OccupancyBufferUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		BufferHandles[BUFFER_IDX_DENSITY_FIELD].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * DensityFieldCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_ROW_PREFIX_SUM].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * RowPrefixSumCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_OCCUPANCY_BITMAP].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * OccupancyBitmapCount, OccupancyBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_OCCUPANCY_OVERFLOW_FLAGS].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * OverflowFlagCount, OccupancyBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_OCCUPANCY_OVERFLOW].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * OverflowCount, OccupancyBufferUsage, VK_SHARING_MODE_EXCLUSIVE);
+		u32 MovedFromCellCount = IncrementalDensity ? MaxParticleCount : 1;
+		BufferHandles[BUFFER_IDX_MOVED_FROM_CELLS].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * MovedFromCellCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_NEIGHBOR_COUNTS].buffer = ArenaBuilder.PushBuffer(sizeof(v2i) * MaxParticleCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		u64 SineTableSize = FIXED_POINT_MOTION ? sizeof(SineTable) : sizeof(s32);
+		BufferHandles[BUFFER_IDX_SINE_TABLE].buffer = ArenaBuilder.PushBuffer(SineTableSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		TrailVisitLength = TrailTimestamps ? WindowWidth * WindowHeight : 0;
+		u32 TrailVisitCount = TrailTimestamps ? TrailVisitLength : 1;
+		BufferHandles[BUFFER_IDX_TRAIL_VISITS].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * TrailVisitCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		// written by vkCmdUpdateBuffer on reset and read as the argument of every per particle dispatch
+		const VkBufferUsageFlags ParticleCountUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		BufferHandles[BUFFER_IDX_PARTICLE_COUNT].buffer = ArenaBuilder.PushBuffer(sizeof(particle_counter), ParticleCountUsage, VK_SHARING_MODE_EXCLUSIVE);
+
+		TileCountX = (Width + SIMULATE_TILE_SIZE - 1) / SIMULATE_TILE_SIZE;
+		TileCountY = (Height + SIMULATE_TILE_SIZE - 1) / SIMULATE_TILE_SIZE;
+		// shared by the tile, Morton and cell list binning passes and the compaction sums of each workgroup of
+		// particles; one extra entry holds the total after the scan
+		u32 MaxCellCount = (WindowWidth / CELL_LIST_MIN_CELL_SIZE + 1) * (WindowHeight / CELL_LIST_MIN_CELL_SIZE + 1);
+		u32 BinCount = S32_Max(S32_Max(TileCountX * TileCountY, MORTON_BIN_COUNT), MaxCellCount);
+		BinCount = S32_Max(BinCount, MaxParticleCount / 128);
+		BufferHandles[BUFFER_IDX_BINS].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * (BinCount + 1), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_BINNED_PARTICLES].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * MaxParticleCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		BufferHandles[BUFFER_IDX_BINNED_POSITIONS].buffer = ArenaBuilder.PushBuffer(sizeof(v2) * MaxParticleCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+
+		FftWidth = 0;
+		FftHeight = 0;
+		if (SimulationEngine == SIMULATION_ENGINE_FFT) {
+			u32 PaddedWidth = RoundUpToPowerOfTwo(Width + 2 * FFT_HALO);
+			u32 PaddedHeight = RoundUpToPowerOfTwo(Height + 2 * FFT_HALO);
+			u64 LayerBytes = (u64)sizeof(v2) * FFT_LAYER_COUNT * PaddedWidth * PaddedHeight;
+			if (PaddedWidth <= FFT_MAX_SIZE && PaddedHeight <= FFT_MAX_SIZE && LayerBytes <= MaxStorageBufferRange) {
+				FftWidth = PaddedWidth;
+				FftHeight = PaddedHeight;
+			} else {
+				printf("the density buffer is too large for the FFT engine, raise the downscale\n");
+				SimulationEngine = SIMULATION_ENGINE_ROW_PREFIX_SUM;
+			}
+		}
+		// the descriptor needs a buffer even while the FFT engine is unused
+		u32 FftLayerLength = (FftWidth != 0) ? FFT_LAYER_COUNT * FftWidth * FftHeight : 1;
+		BufferHandles[BUFFER_IDX_FFT_LAYERS].buffer = ArenaBuilder.PushBuffer(sizeof(v2) * FftLayerLength, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+		FftKernelsDirty = true;
+		BufferHandles[BUFFER_IDX_PARTICLE_BIN_SLOTS].buffer = ArenaBuilder.PushBuffer(sizeof(u32) * MaxParticleCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
 
 		OutputImage = ArenaBuilder.Push2DImage({ WindowWidth, WindowHeight }, ImageFormat, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+		v2i FrameImageSize = AsyncCompute ? v2i{ WindowWidth, WindowHeight } : v2i{ 1, 1 };
+		for (u32 i = 0; i < FramesInFlight; ++i) {
+			FrameImages[i] = ArenaBuilder.Push2DImage(FrameImageSize, ImageFormat, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+		}
 		GPULocalArena = ArenaBuilder.CommitAndAllocateArena(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DeviceProperties);
 	}
 
@@ -247,12 +1069,31 @@ static void CreateSwapchain() {
 
 	UpdateDescriptorSets();
 
-	const auto TransitionImagesCmdList = [](const VkCommandBuffer TempCMD){
-		CmdTransitionImageLayout(TempCMD, OutputImage,
-			{ VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0 },
-			{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT  }
-		);
+	// the simulation's resources are only used on ComputeQueue, so they are set up there
+	const auto InitializeComputeResourcesCmdList = [](const VkCommandBuffer TempCMD){
+		// with PresentDirect or AsyncCompute the output image is never blitted and stays in the general layout
+		if (PresentDirect || AsyncCompute) {
+			CmdTransitionImageLayout(TempCMD, OutputImage,
+				{ VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0 },
+				{ VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT }
+			);
+		} else {
+			CmdTransitionImageLayout(TempCMD, OutputImage,
+				{ VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0 },
+				{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT  }
+			);
+		}
 
+		if (FIXED_POINT_MOTION) {
+			VkBuffer SineTableBuffer = BufferHandles[BUFFER_IDX_SINE_TABLE].buffer;
+			vkCmdUpdateBuffer(TempCMD, SineTableBuffer, 0, sizeof(SineTable), SineTable);
+			CmdBufferMemoryBarrier(TempCMD, SineTableBuffer,
+				{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT },
+				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT }
+			);
+		}
+	};
+	const auto TransitionSwapchainImagesCmdList = [](const VkCommandBuffer TempCMD){
 		for (u32 i = 0; i < SwapchainImageCount; ++i) {
 			CmdTransitionImageLayout(TempCMD, SwapchainImages[i],
 				{ VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0 },
@@ -261,19 +1102,772 @@ static void CreateSwapchain() {
 		}
 	};
 
-	VulkanExecuteCommandsImmediate(Device, CommandPool, Queue, TransitionImagesCmdList);
+	VulkanExecuteCommandsImmediate(Device, ComputeCommandPool, ComputeQueue, InitializeComputeResourcesCmdList);
+	VulkanExecuteCommandsImmediate(Device, CommandPool, Queue, TransitionSwapchainImagesCmdList);
 	ResetParticleState = true;
+	FrameCommandsGeneration += 1;
+}
+
+// Kicks off a build when the requested parameters changed, and swaps in the finished variant once the worker is done
+static void UpdatePipelineVariant() {
+	if (PipelineBuildThread.joinable()) {
+		if (!PipelineBuildFinished.load()) {
+			return;
+		}
+		PipelineBuildThread.join();
+
+		if (!PipelineBuildSucceeded) {
+			// keep running the current variant, and stop asking for the one that failed
+			printf("could not build the pipelines for these parameters, keeping the current ones\n");
+			RequestedSimulationParams = SimulationParams;
+			return;
+		}
+
+		bool DownscaleChanged = PendingBuildJob.Params.DensityBufferDownscale != SimulationParams.DensityBufferDownscale;
+		// frames submitted from now on are recorded with the new variant
+		ReleasePipelineVariant(Pipelines, FrameTimelineValue);
+		for (u32 i = 0; i < PIPELINE_IDX_COUNT; ++i) {
+			Pipelines[i] = PendingPipelines[i];
+		}
+		SimulationParams = PendingBuildJob.Params;
+		FftKernelsDirty = true;
+		FrameCommandsGeneration += 1;
+		PrintSimulationParams(SimulationParams);
+
+		if (DownscaleChanged) {
+			// the density field is sized by the downscale, so it has to be reallocated
+			vkDeviceWaitIdle(Device);
+			CreateSwapchain();
+			FrameNumber = 0;
+			PresentedFrameNumber = 0;
+		}
+	} else if (memcmp(&RequestedSimulationParams, &SimulationParams, sizeof(simulation_params)) != 0) {
+		PendingBuildJob = PipelineBuildJobFor(RequestedSimulationParams);
+		PipelineBuildFinished = false;
+		PipelineBuildThread = std::thread([Job = PendingBuildJob]() {
+			PipelineBuildSucceeded = BuildPipelineVariant(Job, PendingPipelines);
+			PipelineBuildFinished = true;
+		});
+	}
+}
+
+// The FFT layers take FFT_LAYER_COUNT complex values per padded cell, and the occupancy bitmap replaces the density field,
+// so both only exist while their engine is selected. Incremental density updates drop the second density field half,
+// and the trail visits are only allocated in trail mode.
+static void UpdateEngineAllocation() {
+	bool FftAllocated = FftWidth != 0;
+	bool BitmapAllocated = OccupancyRowWords != 0;
+	if ((SimulationEngine == SIMULATION_ENGINE_FFT) != FftAllocated ||
+		(SimulationEngine == SIMULATION_ENGINE_BITMAP) != BitmapAllocated ||
+		(DensityFieldHalves == 1) != IncrementalDensity ||
+		(TrailVisitLength != 0) != TrailTimestamps) {
+		vkDeviceWaitIdle(Device);
+		CreateSwapchain();
+		FrameNumber = 0;
+		PresentedFrameNumber = 0;
+	}
+}
+
+// One invocation per live particle, in workgroups of 128. The count is only known on the GPU, see ParticleCountBuffer.
+// The untimed particle kernels run at DefaultWorkgroupTuning.ParticleGroupSize, which is the same 128.
+static void CmdDispatchParticles(VkCommandBuffer CommandBuffer) {
+	vkCmdDispatchIndirect(CommandBuffer, BufferHandles[BUFFER_IDX_PARTICLE_COUNT].buffer, 0);
+}
+
+// The row prefix sum simulate kernel, whose workgroup size is WorkgroupTuning.ParticleGroupSize
+static void CmdDispatchTunedParticles(VkCommandBuffer CommandBuffer) {
+	vkCmdDispatchIndirect(CommandBuffer, BufferHandles[BUFFER_IDX_PARTICLE_COUNT].buffer, offsetof(particle_counter, TunedDispatchX));
+}
+
+// One invocation per pixel of the output image, in workgroups of the given shape
+static void CmdDispatchImage(VkCommandBuffer CommandBuffer, u32 GroupWidth = DefaultWorkgroupTuning.ImageGroupWidth, u32 GroupHeight = DefaultWorkgroupTuning.ImageGroupHeight) {
+	vkCmdDispatch(CommandBuffer, (WindowWidth + GroupWidth - 1) / GroupWidth, (WindowHeight + GroupHeight - 1) / GroupHeight, 1);
+}
+
+// The fade pass, whose shape is tuned
+static void CmdDispatchTunedImage(VkCommandBuffer CommandBuffer) {
+	CmdDispatchImage(CommandBuffer, WorkgroupTuning.ImageGroupWidth, WorkgroupTuning.ImageGroupHeight);
+}
+
+// Makes the compute writes recorded before visible to the following passes, including the indirect dispatches
+// that read the particle count
+static void CmdParticleCountBarrier(VkCommandBuffer CommandBuffer) {
+	CmdMemoryBarrier(CommandBuffer,
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+		{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		  VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+	);
+}
+
+// Counts the particles per bin and scans the counts into bin offsets, with the bin key the two pipelines were specialized for
+static void CmdCountAndScanBins(VkCommandBuffer CommandBuffer, u32 BinPipelineIndex, u32 ScanPipelineIndex) {
+	VkBuffer BinBuffer = BufferHandles[BUFFER_IDX_BINS].buffer;
+	vkCmdFillBuffer(CommandBuffer, BinBuffer, 0, VK_WHOLE_SIZE, 0);
+	CmdBufferMemoryBarrier(CommandBuffer, BinBuffer,
+		{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT },
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+	);
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[BinPipelineIndex]);
+	CmdDispatchParticles(CommandBuffer);
+	CmdBufferMemoryBarrier(CommandBuffer, BinBuffer,
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+	);
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[ScanPipelineIndex]);
+	vkCmdDispatch(CommandBuffer, 1, 1, 1);
+	VkBuffer ScanOutputs[] = {
+		BinBuffer,
+		BufferHandles[BUFFER_IDX_PARTICLE_BIN_SLOTS].buffer,
+	};
+	for (u32 i = 0; i < ArrayLen(ScanOutputs); ++i) {
+		CmdBufferMemoryBarrier(CommandBuffer, ScanOutputs[i],
+			{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+			{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT }
+		);
+	}
+}
+
+// Writes the particles into bin order after CmdCountAndScanBins
+static void CmdScatterBins(VkCommandBuffer CommandBuffer, u32 ScatterPipelineIndex) {
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[ScatterPipelineIndex]);
+	CmdDispatchParticles(CommandBuffer);
+	VkBuffer ScatterOutputs[] = {
+		BufferHandles[BUFFER_IDX_BINNED_PARTICLES].buffer,
+		BufferHandles[BUFFER_IDX_BINNED_POSITIONS].buffer,
+	};
+	for (u32 i = 0; i < ArrayLen(ScatterOutputs); ++i) {
+		CmdBufferMemoryBarrier(CommandBuffer, ScatterOutputs[i],
+			{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+			{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT }
+		);
+	}
+}
+
+// Zeroes Size bytes of Buffer from Offset, once the compute work recorded before is done with them
+static void CmdZeroBuffer(VkCommandBuffer CommandBuffer, VkBuffer Buffer, VkDeviceSize Offset, VkDeviceSize Size) {
+	CmdBufferMemoryBarrier(CommandBuffer, Buffer,
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT },
+		{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT },
+		Offset, Size
+	);
+	vkCmdFillBuffer(CommandBuffer, Buffer, Offset, Size, 0);
+	CmdBufferMemoryBarrier(CommandBuffer, Buffer,
+		{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT },
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT },
+		Offset, Size
+	);
+}
+
+// Zeroes half Parity of the occupancy buffers, once the previous frame is done reading it
+static void CmdClearOccupancy(VkCommandBuffer CommandBuffer, u32 Parity) {
+	struct occupancy_half {
+		u32 BufferIndex;
+		VkDeviceSize Size;
+	};
+	const occupancy_half Halves[] = {
+		{ BUFFER_IDX_OCCUPANCY_BITMAP, sizeof(u32) * OccupancyBitmapLength },
+		{ BUFFER_IDX_OCCUPANCY_OVERFLOW_FLAGS, sizeof(u32) * OccupancyFlagWordCount() },
+		{ BUFFER_IDX_OCCUPANCY_OVERFLOW, sizeof(u32) * 2 * OCCUPANCY_OVERFLOW_CAPACITY },
+	};
+	for (u32 i = 0; i < ArrayLen(Halves); ++i) {
+		CmdZeroBuffer(CommandBuffer, BufferHandles[Halves[i].BufferIndex].buffer, Parity * Halves[i].Size, Halves[i].Size);
+	}
+}
+
+static void CmdFftLayerBarrier(VkCommandBuffer CommandBuffer) {
+	CmdBufferMemoryBarrier(CommandBuffer, BufferHandles[BUFFER_IDX_FFT_LAYERS].buffer,
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+	);
+}
+
+// 2D transform of LayerCount layers: one workgroup per row, then one per column
+static void CmdFft2D(VkCommandBuffer CommandBuffer, u32 RowPipelineIndex, u32 ColumnPipelineIndex, u32 LayerCount) {
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[RowPipelineIndex]);
+	vkCmdDispatch(CommandBuffer, FftHeight, LayerCount, 1);
+	CmdFftLayerBarrier(CommandBuffer);
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[ColumnPipelineIndex]);
+	vkCmdDispatch(CommandBuffer, FftWidth, LayerCount, 1);
+	CmdFftLayerBarrier(CommandBuffer);
+}
+
+// Leaves the density field being read this frame convolved with every sensing kernel in the response layers
+static void CmdConvolveDensityField(VkCommandBuffer CommandBuffer) {
+	if (FftKernelsDirty) {
+		vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_FFT_KERNELS]);
+		vkCmdDispatch(CommandBuffer, (FftWidth + 15) / 16, (FftHeight + 15) / 16, FFT_KERNEL_PAIRS);
+		CmdFftLayerBarrier(CommandBuffer);
+		CmdFft2D(CommandBuffer, PIPELINE_IDX_FFT_KERNEL_ROWS, PIPELINE_IDX_FFT_KERNEL_COLUMNS, FFT_KERNEL_PAIRS);
+		FftKernelsDirty = false;
+	}
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_FFT_LOAD]);
+	vkCmdDispatch(CommandBuffer, (FftWidth + 15) / 16, (FftHeight + 15) / 16, 1);
+	CmdFftLayerBarrier(CommandBuffer);
+	CmdFft2D(CommandBuffer, PIPELINE_IDX_FFT_ROWS, PIPELINE_IDX_FFT_COLUMNS, 1);
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_FFT_MULTIPLY]);
+	vkCmdDispatch(CommandBuffer, (FftWidth * FftHeight + 255) / 256, FFT_KERNEL_PAIRS, 1);
+	CmdFftLayerBarrier(CommandBuffer);
+	CmdFft2D(CommandBuffer, PIPELINE_IDX_FFT_INVERSE_ROWS, PIPELINE_IDX_FFT_INVERSE_COLUMNS, FFT_KERNEL_PAIRS);
+}
+
+// Copies the reordered particle buffers back over the particle buffers. The live count is only known on the GPU,
+// so everything up to ParticleCountBound is copied.
+static void CmdCopyReorderedParticles(VkCommandBuffer CommandBuffer) {
+	struct reorder_copy {
+		u32 Src;
+		u32 Dst;
+		VkDeviceSize ElementSize;
+	};
+	const reorder_copy Copies[] = {
+		{ BUFFER_IDX_REORDERED_POSITION, BUFFER_IDX_POSITION, ParticleElementSize },
+		{ BUFFER_IDX_REORDERED_ANGLE, BUFFER_IDX_ANGLE, sizeof(f32) },
+		{ BUFFER_IDX_REORDERED_PARTICLE_ID, BUFFER_IDX_PARTICLE_ID, sizeof(u32) },
+	};
+	for (u32 i = 0; i < ArrayLen(Copies); ++i) {
+		if ((PACKED_PARTICLES && Copies[i].Src == BUFFER_IDX_REORDERED_ANGLE) ||
+			(!TRACK_PARTICLE_IDS && Copies[i].Src == BUFFER_IDX_REORDERED_PARTICLE_ID)) {
+			continue;
+		}
+		VkBuffer Src = BufferHandles[Copies[i].Src].buffer;
+		VkBuffer Dst = BufferHandles[Copies[i].Dst].buffer;
+		CmdBufferMemoryBarrier(CommandBuffer, Src,
+			{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+			{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT }
+		);
+		VkBufferCopy Region = { 0, 0, Copies[i].ElementSize * ParticleCountBound };
+		vkCmdCopyBuffer(CommandBuffer, Src, Dst, 1, &Region);
+		CmdBufferMemoryBarrier(CommandBuffer, Dst,
+			{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT },
+			{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+		);
+	}
+}
+
+// Counting sort of the particle buffers by Morton bin: scatter into the reordered buffers and copy those back
+static void CmdReorderParticles(VkCommandBuffer CommandBuffer) {
+	CmdCountAndScanBins(CommandBuffer, PIPELINE_IDX_BIN_PARTICLES_MORTON, PIPELINE_IDX_SCAN_BINS_MORTON);
+
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_REORDER_PARTICLES]);
+	CmdDispatchParticles(CommandBuffer);
+	CmdCopyReorderedParticles(CommandBuffer);
+}
+
+// Applies PendingParticleCount and rebuilds the dispatch arguments from it
+static void CmdUpdateParticleCount(VkCommandBuffer CommandBuffer) {
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_UPDATE_PARTICLE_COUNT]);
+	vkCmdDispatch(CommandBuffer, 1, 1, 1);
+	CmdParticleCountBarrier(CommandBuffer);
+}
+
+// Appends SPAWN_BATCH_SIZE particles in the edit region, up to MaxParticleCount
+static void CmdSpawnParticles(VkCommandBuffer CommandBuffer) {
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_SPAWN_PARTICLES]);
+	vkCmdDispatch(CommandBuffer, (SPAWN_BATCH_SIZE + 127) / 128, 1, 1);
+	CmdParticleCountBarrier(CommandBuffer);
+	CmdUpdateParticleCount(CommandBuffer);
+	ParticleCountBound = (u32)S32_Min(ParticleCountBound + SPAWN_BATCH_SIZE, MaxParticleCount);
+}
+
+// Removes the particles in the edit region and packs the others to the front of the particle buffers in order
+static void CmdDespawnParticles(VkCommandBuffer CommandBuffer) {
+	u32 CompactionPipelines[] = {
+		PIPELINE_IDX_COMPACT_COUNT,
+		PIPELINE_IDX_COMPACT_SCAN,
+		PIPELINE_IDX_COMPACT_SCATTER,
+	};
+	for (u32 i = 0; i < ArrayLen(CompactionPipelines); ++i) {
+		vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[CompactionPipelines[i]]);
+		if (CompactionPipelines[i] == PIPELINE_IDX_COMPACT_SCAN) {
+			vkCmdDispatch(CommandBuffer, 1, 1, 1);
+		} else {
+			CmdDispatchParticles(CommandBuffer);
+		}
+		CmdMemoryBarrier(CommandBuffer,
+			{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+			{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+		);
+	}
+	CmdCopyReorderedParticles(CommandBuffer);
+	CmdUpdateParticleCount(CommandBuffer);
+}
+
+// The compute queue's end of an AsyncCompute frame: copies the shaded OutputImage into the frame's image and releases
+// that to the graphics queue. The copy of the frame that last used the slot was blitted before its timeline value.
+static void CmdCopyToFrameImage(VkCommandBuffer CommandBuffer, u32 Frame) {
+	VkImage FrameImage = FrameImages[Frame];
+	CmdTransitionImageLayout(CommandBuffer, OutputImage,
+		{ VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+		{ VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT }
+	);
+	CmdTransitionImageLayout(CommandBuffer, FrameImage,
+		{ VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0 },
+		{ VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT }
+	);
+
+	VkImageCopy Region = {};
+	Region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	Region.srcSubresource.layerCount = 1;
+	Region.dstSubresource = Region.srcSubresource;
+	Region.extent = { (u32)WindowWidth, (u32)WindowHeight, 1 };
+	vkCmdCopyImage(CommandBuffer, OutputImage, VK_IMAGE_LAYOUT_GENERAL, FrameImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &Region);
+
+	// the release half of the ownership transfer; the destination stage and access are ignored
+	CmdTransitionImageLayout(CommandBuffer, FrameImage,
+		{ VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT },
+		{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0 },
+		ComputeQueueFamilyIndex, QueueFamilyIndex
+	);
+}
+
+// The graphics queue's end of an AsyncCompute frame: acquires the frame's image from the compute queue and blits it
+// to the acquired swapchain image
+static void CmdBlitFrameImage(VkCommandBuffer CommandBuffer, u32 Frame, u32 ImageIndex) {
+	constexpr cmd_image_transition PresentTransition =
+		{ VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0 };
+	constexpr cmd_image_transition TransferDstTransition =
+		{ VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT };
+
+	// the acquire half, with the layouts of the release in CmdCopyToFrameImage; the source stage and access are ignored
+	CmdTransitionImageLayout(CommandBuffer, FrameImages[Frame],
+		{ VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0 },
+		{ VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT },
+		ComputeQueueFamilyIndex, QueueFamilyIndex
+	);
+	CmdTransitionImageLayout(CommandBuffer, SwapchainImages[ImageIndex], PresentTransition, TransferDstTransition);
+	v2i Resolution = { WindowWidth, WindowHeight };
+	CmdBlit2DImage(CommandBuffer, FrameImages[Frame], SwapchainImages[ImageIndex], Resolution, Resolution);
+	CmdTransitionImageLayout(CommandBuffer, SwapchainImages[ImageIndex], TransferDstTransition, PresentTransition);
+}
+
+// The cursor position in pixels of the output image, with y up like the particle positions
+static v2 CursorImagePosition(GLFWwindow *Window) {
+	f64 CursorX, CursorY;
+	glfwGetCursorPos(Window, &CursorX, &CursorY);
+	s32 Width, Height;
+	glfwGetWindowSize(Window, &Width, &Height);
+
+	// the cursor is in screen coordinates, which differ from pixels on high DPI displays
+	f32 ScaleX = (Width > 0) ? (f32)WindowWidth / (f32)Width : 1.0f;
+	f32 ScaleY = (Height > 0) ? (f32)WindowHeight / (f32)Height : 1.0f;
+	return { (f32)CursorX * ScaleX, (f32)WindowHeight - (f32)CursorY * ScaleY };
+}
+
+// Called once the measuring frame's timeline value completed. That frame ends with a barrier to host reads, and the
+// arena is HOST_COHERENT, so the mapping needs no vkInvalidateMappedMemoryRanges.
+static void PrintRefreshError() {
+	refresh_error_stats Result = *(refresh_error_stats *)(GPUVisibleMapping + GPUVisibleArena.MemoryHandles[1].Offset);
+
+	f32 MeanError = Result.CachedParticles ? (f32)Result.CountSum / (f32)Result.CachedParticles : 0.0f;
+	f32 WrongTurnPercentage = Result.CachedParticles ? 100.0f * (f32)Result.WrongTurns / (f32)Result.CachedParticles : 0.0f;
+	printf("refresh period %u: %u particles used cached counts, mean count error %.3f, max %u, %.2f%% turned the wrong way\n",
+		NeighborRefreshPeriod, Result.CachedParticles, MeanError, Result.MaxCount, WrongTurnPercentage);
+}
+
+// Autotuning: on a device without saved results, the first frames run the candidate workgroup shapes in turn. The
+// row prefix sum simulate pass and the fade pass are timed with timestamp queries, and the fastest of every shape's
+// runs counts. Odd rounds run the fused prefix pass in place of the fade pass, and the span from the fade or clear to
+// the end of the prefix pass is timed on both paths to pick FuseClearAndFade.
+static constexpr u32 AutotuneRounds = 16;
+static constexpr u32 AutotuneRoundLength =
+	ArrayLen(ParticleGroupCandidates) > ArrayLen(ImageGroupCandidates) ? ArrayLen(ParticleGroupCandidates) : ArrayLen(ImageGroupCandidates);
+static constexpr u32 AutotuneFrameCount = AutotuneRounds * AutotuneRoundLength;
+static constexpr u32 AutotuneQueriesPerFrame = 6;
+// one line per device: vendor id, device id and driver version in hex, then the workgroup_tuning fields and
+// FuseClearAndFade
+static const char *WorkgroupTuningPath = "workgroup_tuning.txt";
+
+struct autotune_state {
+	bool Active;
+	u32 Frame;
+	f64 NanosecondsPerTick;
+	u64 TimestampMask; // the bits of a timestamp the compute queue family writes
+	VkQueryPool QueryPool; // per frame in flight: the begin and end of the simulate pass, the fade pass, then the fade path
+	VkPipeline ParticlePipelines[ArrayLen(ParticleGroupCandidates)];
+	VkPipeline ImagePipelines[ArrayLen(ImageGroupCandidates)];
+	f64 ParticleTimes[ArrayLen(ParticleGroupCandidates)]; // fastest run so far, in nanoseconds
+	f64 ImageTimes[ArrayLen(ImageGroupCandidates)];
+	f64 FadePathTimes[2]; // the separate fade and prefix passes, then the fused prefix pass
+	s32 TimedParticleCandidate[FramesInFlight]; // recorded in the frame's command buffer, or -1
+	s32 TimedImageCandidate[FramesInFlight];
+	s32 TimedFadePath[FramesInFlight];
+};
+static autotune_state Autotune;
+
+static bool LoadWorkgroupTuning(const VkPhysicalDeviceProperties &Properties) {
+	FILE *File = fopen(WorkgroupTuningPath, "r");
+	if (!File) {
+		return false;
+	}
+
+	// lines written before the fused path was timed lack its field and are skipped, so those devices are tuned again
+	bool Found = false;
+	char Line[128];
+	while (fgets(Line, sizeof(Line), File)) {
+		u32 VendorID, DeviceID, DriverVersion, Fuse;
+		workgroup_tuning Tuning;
+		if (sscanf(Line, "%x %x %x %u %u %u %u", &VendorID, &DeviceID, &DriverVersion,
+				&Tuning.ParticleGroupSize, &Tuning.ImageGroupWidth, &Tuning.ImageGroupHeight, &Fuse) == 7 &&
+			VendorID == Properties.vendorID && DeviceID == Properties.deviceID && DriverVersion == Properties.driverVersion) {
+			WorkgroupTuning = Tuning;
+			FuseClearAndFade = Fuse != 0;
+			Found = true;
+		}
+	}
+	fclose(File);
+	return Found;
+}
+
+static void SaveWorkgroupTuning(const VkPhysicalDeviceProperties &Properties) {
+	FILE *File = fopen(WorkgroupTuningPath, "a");
+	if (!File) {
+		printf("could not write %s, the workgroups will be tuned again next run\n", WorkgroupTuningPath);
+		return;
+	}
+	fprintf(File, "%08x %08x %08x %u %u %u %u\n", Properties.vendorID, Properties.deviceID, Properties.driverVersion,
+		WorkgroupTuning.ParticleGroupSize, WorkgroupTuning.ImageGroupWidth, WorkgroupTuning.ImageGroupHeight, FuseClearAndFade ? 1 : 0);
+	fclose(File);
+}
+
+// Builds a simulate pipeline for every particle candidate and a fade pipeline for every image candidate the device allows
+static void StartAutotune(const VkPhysicalDeviceLimits &Limits, u32 TimestampValidBits) {
+	Autotune = {};
+	Autotune.NanosecondsPerTick = Limits.timestampPeriod;
+	Autotune.TimestampMask = (TimestampValidBits >= 64) ? ~0ull : (1ull << TimestampValidBits) - 1;
+
+	for (u32 i = 0; i < ArrayLen(ParticleGroupCandidates); ++i) {
+		workgroup_tuning Candidate = WorkgroupTuning;
+		Candidate.ParticleGroupSize = ParticleGroupCandidates[i];
+		Autotune.ParticleTimes[i] = INFINITY;
+		if (Candidate.ParticleGroupSize <= Limits.maxComputeWorkGroupSize[0] && Candidate.ParticleGroupSize <= Limits.maxComputeWorkGroupInvocations) {
+			specialization_data Data = SpecializationDataFor(SimulationParams, Candidate, PIPELINE_IDX_SIMULATE);
+			Autotune.ParticlePipelines[i] = CreateSpecializedPipeline(PipelineBuildJobFor(SimulationParams), PIPELINE_IDX_SIMULATE, Data);
+		}
+	}
+	for (u32 i = 0; i < ArrayLen(ImageGroupCandidates); ++i) {
+		workgroup_tuning Candidate = WorkgroupTuning;
+		Candidate.ImageGroupWidth = ImageGroupCandidates[i].X;
+		Candidate.ImageGroupHeight = ImageGroupCandidates[i].Y;
+		Autotune.ImageTimes[i] = INFINITY;
+		if (Candidate.ImageGroupWidth <= Limits.maxComputeWorkGroupSize[0] && Candidate.ImageGroupHeight <= Limits.maxComputeWorkGroupSize[1] &&
+			Candidate.ImageGroupWidth * Candidate.ImageGroupHeight <= Limits.maxComputeWorkGroupInvocations) {
+			specialization_data Data = SpecializationDataFor(SimulationParams, Candidate, PIPELINE_IDX_FADE);
+			Autotune.ImagePipelines[i] = CreateSpecializedPipeline(PipelineBuildJobFor(SimulationParams), PIPELINE_IDX_FADE, Data);
+		}
+	}
+	Autotune.FadePathTimes[0] = INFINITY;
+	Autotune.FadePathTimes[1] = INFINITY;
+	for (u32 i = 0; i < FramesInFlight; ++i) {
+		Autotune.TimedParticleCandidate[i] = -1;
+		Autotune.TimedImageCandidate[i] = -1;
+		Autotune.TimedFadePath[i] = -1;
+	}
+
+	VkQueryPoolCreateInfo QueryPoolInfo = {
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = AutotuneQueriesPerFrame * FramesInFlight
+	};
+	RuntimeAssert(vkCreateQueryPool(Device, &QueryPoolInfo, NULL, &Autotune.QueryPool) == VK_SUCCESS);
+	OnExitPush({
+		if (Autotune.QueryPool) {
+			vkDestroyQueryPool(Device, Autotune.QueryPool, NULL);
+		}
+	});
+	Autotune.Active = true;
+	printf("no saved workgroup sizes for this device, tuning them over the next %u frames\n", AutotuneFrameCount);
+}
+
+// Records the simulate pass of the row prefix sum engine with this frame's particle candidate, between two timestamps.
+// The candidate's group size differs from the dispatch arguments on the GPU, so the dispatch covers ParticleCountBound.
+static void CmdAutotuneSimulate(VkCommandBuffer CommandBuffer, u32 Frame) {
+	u32 Candidate = Autotune.Frame % ArrayLen(ParticleGroupCandidates);
+	if (!Autotune.ParticlePipelines[Candidate]) {
+		vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_SIMULATE]);
+		CmdDispatchTunedParticles(CommandBuffer);
+		return;
+	}
+	u32 GroupSize = ParticleGroupCandidates[Candidate];
+	vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Autotune.QueryPool, AutotuneQueriesPerFrame * Frame);
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Autotune.ParticlePipelines[Candidate]);
+	vkCmdDispatch(CommandBuffer, (ParticleCountBound + GroupSize - 1) / GroupSize, 1, 1);
+	vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Autotune.QueryPool, AutotuneQueriesPerFrame * Frame + 1);
+	Autotune.TimedParticleCandidate[Frame] = (s32)Candidate;
+}
+
+// Records the fade pass with this frame's image candidate, between two timestamps
+static void CmdAutotuneFade(VkCommandBuffer CommandBuffer, u32 Frame) {
+	u32 Candidate = Autotune.Frame % ArrayLen(ImageGroupCandidates);
+	if (!Autotune.ImagePipelines[Candidate]) {
+		vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_FADE]);
+		CmdDispatchTunedImage(CommandBuffer);
+		return;
+	}
+	u32 GroupWidth = (u32)ImageGroupCandidates[Candidate].X;
+	u32 GroupHeight = (u32)ImageGroupCandidates[Candidate].Y;
+	vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Autotune.QueryPool, AutotuneQueriesPerFrame * Frame + 2);
+	vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Autotune.ImagePipelines[Candidate]);
+	vkCmdDispatch(CommandBuffer, (WindowWidth + GroupWidth - 1) / GroupWidth, (WindowHeight + GroupHeight - 1) / GroupHeight, 1);
+	vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Autotune.QueryPool, AutotuneQueriesPerFrame * Frame + 3);
+	Autotune.TimedImageCandidate[Frame] = (s32)Candidate;
+}
+
+// Whether this frame's round runs the fused prefix pass
+static bool AutotuneFusedRound() {
+	return bool((Autotune.Frame / AutotuneRoundLength) & 0x1);
+}
+
+// The fade path span starts before the fade pass or the clear of the write half, and ends once the prefix pass is done
+static void CmdAutotuneFadePathBegin(VkCommandBuffer CommandBuffer, u32 Frame) {
+	vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Autotune.QueryPool, AutotuneQueriesPerFrame * Frame + 4);
+}
+
+static void CmdAutotuneFadePathEnd(VkCommandBuffer CommandBuffer, u32 Frame, bool Fused) {
+	vkCmdWriteTimestamp(CommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, Autotune.QueryPool, AutotuneQueriesPerFrame * Frame + 5);
+	Autotune.TimedFadePath[Frame] = Fused ? 1 : 0;
+}
+
+// Returns the nanoseconds between the timestamps FirstQuery and FirstQuery + 1, once the frame that wrote them is done
+static f64 ReadTimestampInterval(u32 FirstQuery) {
+	u64 Ticks[2] = {};
+	VkResult Result = vkGetQueryPoolResults(Device, Autotune.QueryPool, FirstQuery, 2, sizeof(Ticks), Ticks, sizeof(u64),
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+	RuntimeAssert(Result == VK_SUCCESS);
+	// the counter wraps at TimestampValidBits
+	return (f64)((Ticks[1] - Ticks[0]) & Autotune.TimestampMask) * Autotune.NanosecondsPerTick;
+}
+
+static void ReadAutotuneTimestamps(u32 Frame) {
+	s32 ParticleCandidate = Autotune.TimedParticleCandidate[Frame];
+	if (ParticleCandidate >= 0) {
+		f64 Time = ReadTimestampInterval(AutotuneQueriesPerFrame * Frame);
+		Autotune.ParticleTimes[ParticleCandidate] = fmin(Autotune.ParticleTimes[ParticleCandidate], Time);
+		Autotune.TimedParticleCandidate[Frame] = -1;
+	}
+	s32 ImageCandidate = Autotune.TimedImageCandidate[Frame];
+	if (ImageCandidate >= 0) {
+		f64 Time = ReadTimestampInterval(AutotuneQueriesPerFrame * Frame + 2);
+		Autotune.ImageTimes[ImageCandidate] = fmin(Autotune.ImageTimes[ImageCandidate], Time);
+		Autotune.TimedImageCandidate[Frame] = -1;
+	}
+	s32 FadePath = Autotune.TimedFadePath[Frame];
+	if (FadePath >= 0) {
+		f64 Time = ReadTimestampInterval(AutotuneQueriesPerFrame * Frame + 4);
+		Autotune.FadePathTimes[FadePath] = fmin(Autotune.FadePathTimes[FadePath], Time);
+		Autotune.TimedFadePath[Frame] = -1;
+	}
+}
+
+// Keeps the fastest candidates and the faster fade path, saves them and rebuilds the pipelines with them
+static void FinishAutotune() {
+	vkDeviceWaitIdle(Device);
+	for (u32 i = 0; i < FramesInFlight; ++i) {
+		ReadAutotuneTimestamps(i);
+	}
+
+	// a pass that never ran, because another engine or trail mode was selected throughout, keeps the default
+	workgroup_tuning PreviousTuning = WorkgroupTuning;
+	f64 BestParticleTime = INFINITY;
+	for (u32 i = 0; i < ArrayLen(ParticleGroupCandidates); ++i) {
+		if (Autotune.ParticleTimes[i] < BestParticleTime) {
+			BestParticleTime = Autotune.ParticleTimes[i];
+			WorkgroupTuning.ParticleGroupSize = ParticleGroupCandidates[i];
+		}
+	}
+	f64 BestImageTime = INFINITY;
+	for (u32 i = 0; i < ArrayLen(ImageGroupCandidates); ++i) {
+		if (Autotune.ImageTimes[i] < BestImageTime) {
+			BestImageTime = Autotune.ImageTimes[i];
+			WorkgroupTuning.ImageGroupWidth = (u32)ImageGroupCandidates[i].X;
+			WorkgroupTuning.ImageGroupHeight = (u32)ImageGroupCandidates[i].Y;
+		}
+	}
+	bool PreviousFuseClearAndFade = FuseClearAndFade;
+	if (Autotune.FadePathTimes[0] < INFINITY && Autotune.FadePathTimes[1] < INFINITY) {
+		FuseClearAndFade = Autotune.FadePathTimes[1] < Autotune.FadePathTimes[0];
+	}
+
+	vkDestroyQueryPool(Device, Autotune.QueryPool, NULL);
+	Autotune.QueryPool = VK_NULL_HANDLE;
+	Autotune.Active = false;
+	for (u32 i = 0; i < ArrayLen(Autotune.ParticlePipelines); ++i) {
+		VulkanReleaseComputePipeline(Autotune.ParticlePipelines[i], FrameTimelineValue);
+		Autotune.ParticlePipelines[i] = VK_NULL_HANDLE;
+	}
+	for (u32 i = 0; i < ArrayLen(Autotune.ImagePipelines); ++i) {
+		VulkanReleaseComputePipeline(Autotune.ImagePipelines[i], FrameTimelineValue);
+		Autotune.ImagePipelines[i] = VK_NULL_HANDLE;
+	}
+
+	// A variant still being built has the old workgroup sizes and is dropped. RequestedSimulationParams still differs
+	// from SimulationParams, so the next UpdatePipelineVariant queues it again with the tuned ones.
+	if (PipelineBuildThread.joinable()) {
+		PipelineBuildThread.join();
+		if (PipelineBuildSucceeded) {
+			ReleasePipelineVariant(PendingPipelines, 0);
+		}
+	}
+
+	VkPipeline Tuned[PIPELINE_IDX_COUNT];
+	if (!BuildPipelineVariant(PipelineBuildJobFor(SimulationParams), Tuned)) {
+		printf("could not build the pipelines with the tuned workgroup sizes, keeping the current ones\n");
+		WorkgroupTuning = PreviousTuning;
+		FuseClearAndFade = PreviousFuseClearAndFade;
+		return;
+	}
+	printf("tuned workgroup sizes: %u invocations per particle group, %ux%u per image group, fused clear and fade %s\n",
+		WorkgroupTuning.ParticleGroupSize, WorkgroupTuning.ImageGroupWidth, WorkgroupTuning.ImageGroupHeight, FuseClearAndFade ? "on" : "off");
+
+	VkPhysicalDeviceProperties Properties = {};
+	vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+	SaveWorkgroupTuning(Properties);
+
+	// the device is idle, nothing in flight uses the old variant
+	ReleasePipelineVariant(Pipelines, FrameTimelineValue);
+	for (u32 i = 0; i < PIPELINE_IDX_COUNT; ++i) {
+		Pipelines[i] = Tuned[i];
+	}
+	ParticleDispatchStale = true;
+	FrameCommandsGeneration += 1;
+}
+
+// Fast-forward governor: scales SubstepCount by how far the smoothed frame time is from the target. Under FIFO
+// presentation a frame takes at least one refresh interval, so below it the count grows until the GPU is the limit.
+// The band around the target keeps the count, and with it the cached command buffers, from changing every frame.
+static void UpdateSubstepCount() {
+	f64 Now = glfwGetTime();
+	f64 FrameTime = Now - LastFrameStartTime;
+	LastFrameStartTime = Now;
+
+	// the autotune timestamps time a single pass per frame
+	if (!FastForward || Autotune.Active) {
+		SubstepCount = 1;
+		SmoothedFrameTime = 0.0;
+		return;
+	}
+	if (GovernorHoldFrames > 0) {
+		GovernorHoldFrames -= 1;
+		return;
+	}
+
+	SmoothedFrameTime = (SmoothedFrameTime == 0.0) ? FrameTime : 0.8 * SmoothedFrameTime + 0.2 * FrameTime;
+	f64 Ratio = FastForwardFrameTime / SmoothedFrameTime;
+	if (Ratio > 0.9 && Ratio < 1.1) {
+		return;
+	}
+	// at most doubled or halved per step, so one slow frame does not throw the count off
+	f64 Target = (f64)SubstepCount * fmin(fmax(Ratio, 0.5), 2.0);
+	u32 NewCount = (u32)S32_Clamp((s32)(Target + 0.5), 1, MaxSubstepCount);
+	if (NewCount != SubstepCount) {
+		SubstepCount = NewCount;
+		SmoothedFrameTime = 0.0;
+		GovernorHoldFrames = FramesInFlight + 1;
+	}
 }
 
 void KeyCallback(GLFWwindow *Window, int Key, int ScanCode, int Action, int Mods) {
-	if (Key == GLFW_KEY_R && Action == GLFW_PRESS) {
-		ResetParticleState = true;
+	if (Action != GLFW_PRESS) {
+		return;
+	}
+
+	simulation_params &Params = RequestedSimulationParams;
+	switch (Key) {
+		case GLFW_KEY_R: {
+			ResetParticleState = true;
+		} break;
+		case GLFW_KEY_N: {
+			SpawnRequested = true;
+			EditRegion = CursorImagePosition(Window);
+		} break;
+		case GLFW_KEY_X: {
+			DespawnRequested = true;
+			EditRegion = CursorImagePosition(Window);
+		} break;
+		case GLFW_KEY_1:
+		case GLFW_KEY_2:
+		case GLFW_KEY_3:
+		case GLFW_KEY_4:
+		case GLFW_KEY_5: {
+			SimulationEngine = Key - GLFW_KEY_1;
+			printf("simulation engine: %s\n", SimulationEngineNames[SimulationEngine]);
+			if (FIXED_POINT_MOTION && SimulationEngine == SIMULATION_ENGINE_FFT) {
+				printf("the FFT engine senses in float, so its runs are not bit-exact across devices\n");
+			}
+		} break;
+		case GLFW_KEY_D: {
+			IncrementalDensity = !IncrementalDensity;
+			printf("incremental density updates: %s\n", IncrementalDensity ? "on" : "off");
+		} break;
+		case GLFW_KEY_K: {
+			NeighborRefreshPeriod = (NeighborRefreshPeriod < 16) ? NeighborRefreshPeriod * 2 : 1;
+			NeighborCountsValid = false;
+			printf("neighbor refresh period: %u frames%s\n", NeighborRefreshPeriod, (NeighborRefreshPeriod == 1) ? " (exact)" : "");
+		} break;
+		case GLFW_KEY_E: {
+			RefreshErrorRequested = true;
+		} break;
+		case GLFW_KEY_G: {
+			FastForward = !FastForward;
+			printf("fast-forward: %s\n", FastForward ? "on" : "off");
+		} break;
+		case GLFW_KEY_F: {
+			FuseClearAndFade = !FuseClearAndFade;
+			printf("fused clear and fade: %s\n", FuseClearAndFade ? "on" : "off");
+		} break;
+		case GLFW_KEY_T: {
+			TrailTimestamps = !TrailTimestamps;
+			printf("timestamp trails: %s\n", TrailTimestamps ? "on" : "off");
+		} break;
+		case GLFW_KEY_O: {
+			ReorderParticles = !ReorderParticles;
+			printf("particle reordering: %s\n", ReorderParticles ? "on" : "off");
+		} break;
+		case GLFW_KEY_COMMA: {
+			ReorderInterval = (ReorderInterval > 1) ? ReorderInterval / 2 : 1;
+			printf("reorder interval: %u frames\n", ReorderInterval);
+		} break;
+		case GLFW_KEY_PERIOD: {
+			ReorderInterval = (u32)S32_Min(ReorderInterval * 2, 4096);
+			printf("reorder interval: %u frames\n", ReorderInterval);
+		} break;
+		case GLFW_KEY_LEFT_BRACKET: {
+			Params.SearchRadiusSquared = (Params.SearchRadiusSquared > 8) ? Params.SearchRadiusSquared - 8 : 1;
+		} break;
+		case GLFW_KEY_RIGHT_BRACKET: {
+			Params.SearchRadiusSquared = (u32)S32_Min(Params.SearchRadiusSquared + 8, MAX_DISC_ROWS * MAX_DISC_ROWS);
+		} break;
+		case GLFW_KEY_DOWN: {
+			Params.Alpha -= 1.0f;
+		} break;
+		case GLFW_KEY_UP: {
+			Params.Alpha += 1.0f;
+		} break;
+		case GLFW_KEY_LEFT: {
+			Params.Beta -= 1.0f;
+		} break;
+		case GLFW_KEY_RIGHT: {
+			Params.Beta += 1.0f;
+		} break;
+		case GLFW_KEY_MINUS: {
+			Params.DensityBufferDownscale = (Params.DensityBufferDownscale > 1) ? Params.DensityBufferDownscale - 1 : 1;
+		} break;
+		case GLFW_KEY_EQUAL: {
+			Params.DensityBufferDownscale = (u32)S32_Min(Params.DensityBufferDownscale + 1, 8);
+		} break;
 	}
 }
 
 s32 main() {
 	Temp = CreateMemoryArena(MB(32));
 
+	for (u32 i = 0; i < ArrayLen(SineTable); ++i) {
+		f64 Angle = (f64)i / (f64)ArrayLen(SineTable) * 1.5707963267948966; // π / 2
+		SineTable[i] = (s32)lround(sin(Angle) * (f64)(1 << SINE_TABLE_BITS));
+	}
+
 	// Init
 	{
 		RuntimeAssert(glfwInit());
@@ -284,7 +1878,7 @@ s32 main() {
 		AppInfo.pApplicationName = "Primordial Particle System";
 		AppInfo.pEngineName = "N/A";
 		AppInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		AppInfo.apiVersion = VK_API_VERSION_1_0;
+		AppInfo.apiVersion = VK_API_VERSION_1_2;
 
 		VkInstanceCreateInfo CreateInfo = {};
 		CreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -321,9 +1915,9 @@ s32 main() {
 				vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevices[i], &QueuePropertiesCount, QueuePropertiesList);
 				
 				for (u32 j = 0; j < QueuePropertiesCount; ++j) {
-					bool SupportsGraphics = (QueuePropertiesList[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
-					bool SupportsCompute = (QueuePropertiesList[i].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
-					bool SupportsTransfer = (QueuePropertiesList[i].queueFlags & VK_QUEUE_TRANSFER_BIT) != 0;
+					bool SupportsGraphics = (QueuePropertiesList[j].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+					bool SupportsCompute = (QueuePropertiesList[j].queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+					bool SupportsTransfer = (QueuePropertiesList[j].queueFlags & VK_QUEUE_TRANSFER_BIT) != 0;
 					bool SupportsPresentation = glfwGetPhysicalDevicePresentationSupport(Instance, PhysicalDevices[i], j);
 
 					if (SupportsGraphics && SupportsCompute && SupportsTransfer && SupportsPresentation) {
@@ -333,19 +1927,85 @@ s32 main() {
 					}
 				}
 
+				// a compute family without graphics usually feeds a separate engine, which can overlap the graphics queue
+				for (u32 j = 0; j < QueuePropertiesCount && DeviceSelection == i; ++j) {
+					VkQueueFlags Flags = QueuePropertiesList[j].queueFlags;
+					if ((Flags & VK_QUEUE_COMPUTE_BIT) && !(Flags & VK_QUEUE_GRAPHICS_BIT)) {
+						ComputeQueueFamilyIndex = j;
+						break;
+					}
+				}
+
 				Pop(&Temp, QueuePropertiesList);
 			}
 
 			RuntimeAssert(DeviceSelection != -1);
 			RuntimeAssert(QueueFamilyIndex != -1);
 			PhysicalDevice = PhysicalDevices[DeviceSelection];
+			AsyncCompute = ComputeQueueFamilyIndex != -1;
+			if (!AsyncCompute) {
+				ComputeQueueFamilyIndex = QueueFamilyIndex;
+			}
+			printf("async compute queue: %s\n", AsyncCompute ? "on" : "off");
+
+			VkPhysicalDeviceProperties DeviceProperties = {};
+			vkGetPhysicalDeviceProperties(PhysicalDevice, &DeviceProperties);
+			MaxComputeSharedMemorySize = DeviceProperties.limits.maxComputeSharedMemorySize;
+			MaxComputeWorkGroupInvocations = DeviceProperties.limits.maxComputeWorkGroupInvocations;
+			MaxStorageBufferRange = DeviceProperties.limits.maxStorageBufferRange;
+
+			if (DeviceProperties.apiVersion >= VK_API_VERSION_1_1) {
+				VkPhysicalDeviceSubgroupProperties SubgroupProperties = {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES
+				};
+				VkPhysicalDeviceProperties2 Properties2 = {
+					.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+					.pNext = &SubgroupProperties
+				};
+				vkGetPhysicalDeviceProperties2(PhysicalDevice, &Properties2);
+				SubgroupDeposit = (SubgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+					(SubgroupProperties.supportedOperations & VK_SUBGROUP_FEATURE_BALLOT_BIT);
+			}
+			printf("subgroup density deposit: %s\n", SubgroupDeposit ? "on" : "off");
+
+			VkPhysicalDeviceFeatures SupportedFeatures = {};
+			vkGetPhysicalDeviceFeatures(PhysicalDevice, &SupportedFeatures);
+			const VkFormatFeatureFlags OutputFormatFeatures = VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT;
+			VkFormatProperties OutputFormatProperties = {};
+			vkGetPhysicalDeviceFormatProperties(PhysicalDevice, VK_FORMAT_R8G8_UNORM, &OutputFormatProperties);
+			OutputImageRG8 = SupportedFeatures.shaderStorageImageExtendedFormats &&
+				(OutputFormatProperties.optimalTilingFeatures & OutputFormatFeatures) == OutputFormatFeatures;
+			OutputImageFormat = OutputImageRG8 ? VK_FORMAT_R8G8_UNORM : VK_FORMAT_R8G8B8A8_UNORM;
+			vkGetPhysicalDeviceFormatProperties(PhysicalDevice, OutputImageFormat, &OutputFormatProperties);
+			RuntimeAssert((OutputFormatProperties.optimalTilingFeatures & OutputFormatFeatures) == OutputFormatFeatures);
+			printf("two byte output image: %s\n", OutputImageRG8 ? "on" : "off");
+			VkPhysicalDeviceFeatures EnabledFeatures = {};
+			// needed to write swapchain images, whose formats have no GLSL qualifier; see PresentDirect
+			StorageImageWriteWithoutFormat = SupportedFeatures.shaderStorageImageWriteWithoutFormat;
+			EnabledFeatures.shaderStorageImageWriteWithoutFormat = SupportedFeatures.shaderStorageImageWriteWithoutFormat;
+			EnabledFeatures.shaderStorageImageExtendedFormats = OutputImageRG8;
+
+			// frames in flight are paced with a timeline semaphore, core since Vulkan 1.2
+			RuntimeAssert(DeviceProperties.apiVersion >= VK_API_VERSION_1_2);
+			VkPhysicalDeviceTimelineSemaphoreFeatures TimelineSemaphoreFeatures = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES
+			};
+			VkPhysicalDeviceFeatures2 Features2 = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &TimelineSemaphoreFeatures
+			};
+			vkGetPhysicalDeviceFeatures2(PhysicalDevice, &Features2);
+			RuntimeAssert(TimelineSemaphoreFeatures.timelineSemaphore);
 
 			f32 Priority = 1.0f;
-			VkDeviceQueueCreateInfo QueueCreateInfo = {};
-			QueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-			QueueCreateInfo.queueFamilyIndex = QueueFamilyIndex;
-			QueueCreateInfo.queueCount = 1;
-			QueueCreateInfo.pQueuePriorities = &Priority;
+			VkDeviceQueueCreateInfo QueueCreateInfos[2] = {};
+			u32 QueueFamilyIndices[] = { QueueFamilyIndex, ComputeQueueFamilyIndex };
+			for (u32 i = 0; i < ArrayLen(QueueCreateInfos); ++i) {
+				QueueCreateInfos[i].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+				QueueCreateInfos[i].queueFamilyIndex = QueueFamilyIndices[i];
+				QueueCreateInfos[i].queueCount = 1;
+				QueueCreateInfos[i].pQueuePriorities = &Priority;
+			}
 
 			const char *DeviceExtensions[] = {
 				"VK_KHR_swapchain"
@@ -353,15 +2013,18 @@ s32 main() {
 
 			VkDeviceCreateInfo DeviceCreateInfo = {};
 			DeviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-			DeviceCreateInfo.queueCreateInfoCount = 1;
-			DeviceCreateInfo.pQueueCreateInfos = &QueueCreateInfo;
+			DeviceCreateInfo.queueCreateInfoCount = AsyncCompute ? 2 : 1;
+			DeviceCreateInfo.pQueueCreateInfos = QueueCreateInfos;
 			DeviceCreateInfo.enabledExtensionCount = ArrayLen(DeviceExtensions);
 			DeviceCreateInfo.ppEnabledExtensionNames = DeviceExtensions;
+			DeviceCreateInfo.pEnabledFeatures = &EnabledFeatures;
+			DeviceCreateInfo.pNext = &TimelineSemaphoreFeatures;
 
 			RuntimeAssert(vkCreateDevice(PhysicalDevice, &DeviceCreateInfo, NULL, &Device) == VK_SUCCESS);
 			OnExitPush(vkDestroyDevice(Device, NULL));
 
 			vkGetDeviceQueue(Device, QueueFamilyIndex, 0, &Queue);
+			vkGetDeviceQueue(Device, ComputeQueueFamilyIndex, 0, &ComputeQueue);
 		}
 
 		{
@@ -374,6 +2037,17 @@ s32 main() {
 			glfwCreateWindowSurface(Instance, Window, NULL, &Surface);
 			RuntimeAssert(Surface);
 
+			// decided once, since the pipelines are built for one path or the other
+			VkSurfaceCapabilitiesKHR Capabilities = {};
+			vkGetPhysicalDeviceSurfaceCapabilitiesKHR(PhysicalDevice, Surface, &Capabilities);
+			VkFormatProperties SwapchainFormatProperties = {};
+			vkGetPhysicalDeviceFormatProperties(PhysicalDevice, VulkanGetBestAvailableFormatAndColor(PhysicalDevice, Surface).Format, &SwapchainFormatProperties);
+			// the compute family need not be able to present, so AsyncCompute always blits
+			PresentDirect = !AsyncCompute && StorageImageWriteWithoutFormat &&
+				(Capabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) &&
+				(SwapchainFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+			printf("direct swapchain writes: %s\n", PresentDirect ? "on" : "off");
+
 			OnExitPush({
 				vkDestroySurfaceKHR(Instance, Surface, NULL);
 				glfwDestroyWindow(Window);
@@ -389,38 +2063,16 @@ s32 main() {
 				.descriptorCount = 1,
 				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
 			};
-			VkDescriptorSetLayoutBinding UniformBufferBinding = {
-				.binding = 1,
-				.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-				.descriptorCount = 1,
-				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-			};
-			VkDescriptorSetLayoutBinding PositionBinding = {
-				.binding = 2,
-				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-				.descriptorCount = 1,
-				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-			};
-			VkDescriptorSetLayoutBinding AngleBinding = {
-				.binding = 3,
-				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-				.descriptorCount = 1,
-				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-			};
-			VkDescriptorSetLayoutBinding DensityFieldBinding = {
-				.binding = 4,
-				.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-				.descriptorCount = 1,
-				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-			};
 
-			VkDescriptorSetLayoutBinding Bindings[] = {
-				ImageBinding,
-				UniformBufferBinding,
-				PositionBinding,
-				AngleBinding,
-				DensityFieldBinding
-			};
+			VkDescriptorSetLayoutBinding Bindings[1 + BUFFER_IDX_COUNT] = { ImageBinding };
+			for (u32 i = 0; i < BUFFER_IDX_COUNT; ++i) {
+				Bindings[1 + i] = {
+					.binding = 1 + i,
+					.descriptorType = (i == BUFFER_IDX_UNIFORM) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+					.descriptorCount = 1,
+					.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				};
+			}
 
 			bool Succeeded = true;
 
@@ -432,55 +2084,96 @@ s32 main() {
 			RuntimeAssert(vkCreateDescriptorSetLayout(Device, &LayoutInfo, NULL, &DescriptorSetLayout) == VK_SUCCESS);
 			OnExitPush(vkDestroyDescriptorSetLayout(Device, DescriptorSetLayout, NULL));
 
+			VkDescriptorSetLayoutBinding PresentImageBinding = ImageBinding;
+			VkDescriptorSetLayoutCreateInfo PresentLayoutInfo = {
+				.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+				.bindingCount = 1,
+				.pBindings = &PresentImageBinding
+			};
+			RuntimeAssert(vkCreateDescriptorSetLayout(Device, &PresentLayoutInfo, NULL, &PresentDescriptorSetLayout) == VK_SUCCESS);
+			OnExitPush(vkDestroyDescriptorSetLayout(Device, PresentDescriptorSetLayout, NULL));
+
 			VkDescriptorPoolSize PoolSizes[3] = {
 				{
 					.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
-					.descriptorCount = 1
+					.descriptorCount = FramesInFlight + MaxSwapchainImageCount
 				},
 				{
 					.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-					.descriptorCount = 1
+					.descriptorCount = FramesInFlight
 				},
 				{
 					.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-					.descriptorCount = 3
+					.descriptorCount = FramesInFlight * (BUFFER_IDX_COUNT - 1)
 				},
 			};
 			VkDescriptorPoolCreateInfo PoolInfo = {};
 			PoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 			PoolInfo.poolSizeCount = ArrayLen(PoolSizes);
 			PoolInfo.pPoolSizes = PoolSizes;
-			PoolInfo.maxSets = 1;
+			PoolInfo.maxSets = FramesInFlight + MaxSwapchainImageCount;
 			RuntimeAssert(vkCreateDescriptorPool(Device, &PoolInfo, NULL, &DescriptorPool) == VK_SUCCESS);
 			OnExitPush(vkDestroyDescriptorPool(Device, DescriptorPool, NULL));
 
 			VkDescriptorSetAllocateInfo DescriptorSetAllocInfo = {};
 			DescriptorSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 			DescriptorSetAllocInfo.descriptorPool = DescriptorPool;
-			DescriptorSetAllocInfo.descriptorSetCount = 1;
-			DescriptorSetAllocInfo.pSetLayouts = &DescriptorSetLayout;
-			RuntimeAssert(vkAllocateDescriptorSets(Device, &DescriptorSetAllocInfo, &DescriptorSet) == VK_SUCCESS);
+			VkDescriptorSetLayout FrameSetLayouts[FramesInFlight];
+			for (u32 i = 0; i < FramesInFlight; ++i) {
+				FrameSetLayouts[i] = DescriptorSetLayout;
+			}
+			DescriptorSetAllocInfo.descriptorSetCount = FramesInFlight;
+			DescriptorSetAllocInfo.pSetLayouts = FrameSetLayouts;
+			RuntimeAssert(vkAllocateDescriptorSets(Device, &DescriptorSetAllocInfo, DescriptorSets) == VK_SUCCESS);
 			// OnExitPush([](){ vkFreeDescriptorSets(Device, DescriptorPool, 1, &DescriptorSet); });
 
+			VkDescriptorSetLayout PresentSetLayouts[MaxSwapchainImageCount];
+			for (u32 i = 0; i < MaxSwapchainImageCount; ++i) {
+				PresentSetLayouts[i] = PresentDescriptorSetLayout;
+			}
+			DescriptorSetAllocInfo.descriptorSetCount = MaxSwapchainImageCount;
+			DescriptorSetAllocInfo.pSetLayouts = PresentSetLayouts;
+			RuntimeAssert(vkAllocateDescriptorSets(Device, &DescriptorSetAllocInfo, PresentDescriptorSets) == VK_SUCCESS);
+
+			// set 1 is only bound, and only used by the PRESENT_DIRECT builds, with PresentDirect
+			VkDescriptorSetLayout SetLayouts[] = { DescriptorSetLayout, PresentDescriptorSetLayout };
+			VkPushConstantRange SubstepConstantRange = {
+				.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+				.offset = 0,
+				.size = sizeof(substep_constants)
+			};
 			VkPipelineLayoutCreateInfo PipelineLayoutInfo = {
 				.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-				.setLayoutCount = 1,
-				.pSetLayouts = &DescriptorSetLayout
+				.setLayoutCount = ArrayLen(SetLayouts),
+				.pSetLayouts = SetLayouts,
+				.pushConstantRangeCount = 1,
+				.pPushConstantRanges = &SubstepConstantRange
 			};
 			RuntimeAssert(vkCreatePipelineLayout(Device, &PipelineLayoutInfo, NULL, &PipelineLayout) == VK_SUCCESS);
 			OnExitPush(vkDestroyPipelineLayout(Device, PipelineLayout, NULL));
 
-			ResetComputePipeline = VulkanCreateComputeShaderPipeline(CreateRange(ResetComputeShader), PipelineLayout);
-			ClearComputePipeline = VulkanCreateComputeShaderPipeline(CreateRange(ClearComputeShader), PipelineLayout);
-			FadeComputePipeline = VulkanCreateComputeShaderPipeline(CreateRange(FadeComputeShader), PipelineLayout);
-			SimulateComputePipeline = VulkanCreateComputeShaderPipeline(CreateRange(SimulateComputeShader), PipelineLayout);
-			RenderDensityBufferComputePipeline = VulkanCreateComputeShaderPipeline(CreateRange(RenderDensityBufferComputeShader), PipelineLayout);
+			VkPhysicalDeviceProperties TuningDeviceProperties = {};
+			vkGetPhysicalDeviceProperties(PhysicalDevice, &TuningDeviceProperties);
+			// the timed passes run on the compute queue, so its family has to write timestamps
+			VkQueueFamilyProperties TimestampFamilies[16] = {};
+			u32 TimestampFamilyCount = ArrayLen(TimestampFamilies);
+			vkGetPhysicalDeviceQueueFamilyProperties(PhysicalDevice, &TimestampFamilyCount, TimestampFamilies);
+			u32 TimestampValidBits = (ComputeQueueFamilyIndex < TimestampFamilyCount) ? TimestampFamilies[ComputeQueueFamilyIndex].timestampValidBits : 0;
+			if (LoadWorkgroupTuning(TuningDeviceProperties)) {
+				printf("saved workgroup sizes: %u invocations per particle group, %ux%u per image group, fused clear and fade %s\n",
+					WorkgroupTuning.ParticleGroupSize, WorkgroupTuning.ImageGroupWidth, WorkgroupTuning.ImageGroupHeight, FuseClearAndFade ? "on" : "off");
+			} else if (TimestampValidBits != 0 && TuningDeviceProperties.limits.timestampPeriod > 0.0f) {
+				StartAutotune(TuningDeviceProperties.limits, TimestampValidBits);
+			} else {
+				printf("no timestamp queries to tune the workgroup sizes with, using the defaults\n");
+			}
+
+			RuntimeAssert(BuildPipelineVariant(PipelineBuildJobFor(SimulationParams), Pipelines));
+			OnExitPush(VulkanDestroyCachedComputePipelines());
 			OnExitPush({
-				vkDestroyPipeline(Device, ResetComputePipeline, NULL);
-				vkDestroyPipeline(Device, ClearComputePipeline, NULL);
-				vkDestroyPipeline(Device, FadeComputePipeline, NULL);
-				vkDestroyPipeline(Device, SimulateComputePipeline, NULL);
-				vkDestroyPipeline(Device, RenderDensityBufferComputePipeline, NULL);
+				if (PipelineBuildThread.joinable()) {
+					PipelineBuildThread.join();
+				}
 			});
 
 			RuntimeAssert(Succeeded);
@@ -488,15 +2181,25 @@ s32 main() {
 			VkPhysicalDeviceMemoryProperties DeviceProperties;
 			vkGetPhysicalDeviceMemoryProperties(PhysicalDevice, &DeviceProperties);
 
-			const VkFormat ImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
-
 			{
-				vulkan_arena_builder<1> ArenaBuilder = StartBuildingMemoryArena<1>(Device);
-				BufferHandles[BUFFER_IDX_UNIFORM].buffer = ArenaBuilder.PushBuffer(sizeof(uniform_data), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+				vulkan_arena_builder<2> ArenaBuilder = StartBuildingMemoryArena<2>(Device);
+				// one slice per frame in flight, so the host can write the next frame's while the GPU reads the current one's
+				VkPhysicalDeviceProperties Properties = {};
+				vkGetPhysicalDeviceProperties(PhysicalDevice, &Properties);
+				VkDeviceSize Alignment = Properties.limits.minUniformBufferOffsetAlignment;
+				UniformStride = (sizeof(uniform_data) + Alignment - 1) / Alignment * Alignment;
+				BufferHandles[BUFFER_IDX_UNIFORM].buffer = ArenaBuilder.PushBuffer(FramesInFlight * UniformStride, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+				BufferHandles[BUFFER_IDX_REFRESH_ERRORS].buffer = ArenaBuilder.PushBuffer(sizeof(refresh_error_stats), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
 				GPUVisibleArena = ArenaBuilder.CommitAndAllocateArena(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, DeviceProperties);
 			}
+			vkMapMemory(Device, GPUVisibleArena.Memory, 0, VK_WHOLE_SIZE, 0, (void **)&GPUVisibleMapping);
+			// the slices start out matching UniformSliceContents, so the first write of each one covers every nonzero word
+			for (u32 Frame = 0; Frame < FramesInFlight; ++Frame) {
+				memset(GPUVisibleMapping + GPUVisibleArena.MemoryHandles[0].Offset + Frame * UniformStride, 0, sizeof(uniform_data));
+			}
 			OnExitPush({
 				GPULocalArena.Destroy(Device);
+				vkUnmapMemory(Device, GPUVisibleArena.Memory);
 				GPUVisibleArena.Destroy(Device);
 			});
 
@@ -516,13 +2219,26 @@ s32 main() {
 			RuntimeAssert(vkCreateCommandPool(Device, &CommandPoolCreateInfo, NULL, &CommandPool) == VK_SUCCESS);
 			OnExitPush(vkDestroyCommandPool(Device, CommandPool, NULL));
 
-			VulkanAllocateCommandBuffers(Device, CommandPool, CreateRange(CommandBuffers));
-			OnExitPush(vkFreeCommandBuffers(Device, CommandPool, ArrayLen(CommandBuffers), CommandBuffers));
+			ComputeCommandPool = CommandPool;
+			if (AsyncCompute) {
+				CommandPoolCreateInfo.queueFamilyIndex = ComputeQueueFamilyIndex;
+				RuntimeAssert(vkCreateCommandPool(Device, &CommandPoolCreateInfo, NULL, &ComputeCommandPool) == VK_SUCCESS);
+				OnExitPush(vkDestroyCommandPool(Device, ComputeCommandPool, NULL));
+
+				VulkanAllocateCommandBuffers(Device, CommandPool, CreateRange(BlitCommands));
+				OnExitPush(vkFreeCommandBuffers(Device, CommandPool, ArrayLen(BlitCommands), BlitCommands));
+			}
+
+			VulkanAllocateCommandBuffers(Device, ComputeCommandPool, CreateRange(CommandBuffers));
+			OnExitPush(vkFreeCommandBuffers(Device, ComputeCommandPool, ArrayLen(CommandBuffers), CommandBuffers));
+			VulkanAllocateCommandBuffers(Device, ComputeCommandPool, CreateRange(CachedFrameCommands));
+			OnExitPush(vkFreeCommandBuffers(Device, ComputeCommandPool, ArrayLen(CachedFrameCommands), CachedFrameCommands));
 		}
 
 		CreateSwapchain();
 		OnExitPush(vkDestroySwapchainKHR(Device, Swapchain, NULL));
 		OnExitPush(vkDestroyImageView(Device, OutputImageView, NULL));
+		OnExitPush(DestroySwapchainImageViews());
 
 		Reset(&Temp);
 	}
@@ -531,15 +2247,18 @@ s32 main() {
 		for (u32 i = 0; i < FramesInFlight; ++i) {
 			ImageAvailableSemaphores[i] = VulkanCreateSemaphore(Device);
 			RenderFinishedSemaphores[i] = VulkanCreateSemaphore(Device);
-			InFlightFences[i] = VulkanCreateFence(Device, true);
+			ComputeFinishedSemaphores[i] = VulkanCreateSemaphore(Device);
+			FrameTimelineValues[i] = 0;
 		}
+		FrameTimeline = VulkanCreateTimelineSemaphore(Device, 0);
 
 		OnExitPush({
 			for (u32 i = 0; i < FramesInFlight; ++i) {
 				vkDestroySemaphore(Device, ImageAvailableSemaphores[i], NULL);
 				vkDestroySemaphore(Device, RenderFinishedSemaphores[i], NULL);
-				vkDestroyFence(Device, InFlightFences[i], NULL);
+				vkDestroySemaphore(Device, ComputeFinishedSemaphores[i], NULL);
 			}
+			vkDestroySemaphore(Device, FrameTimeline, NULL);
 		});
 	}
 
@@ -548,8 +2267,27 @@ s32 main() {
 
 	while (!glfwWindowShouldClose(Window)) {
 
-		RuntimeAssert(vkWaitForFences(Device, 1, InFlightFences + CurrentFrame, VK_TRUE, UINT64_MAX) == VK_SUCCESS);
+		// wait for the last frame that used this slot, the other frames in flight keep the GPU busy meanwhile
+		VulkanWaitTimelineSemaphore(Device, FrameTimeline, FrameTimelineValues[CurrentFrame]);
+		VulkanDestroyRetiredComputePipelines(FrameTimelineValues[CurrentFrame]);
+		if (RefreshErrorPending) {
+			u64 CompletedValue = 0;
+			vkGetSemaphoreCounterValue(Device, FrameTimeline, &CompletedValue);
+			if (CompletedValue >= RefreshErrorTimelineValue) {
+				PrintRefreshError();
+				RefreshErrorPending = false;
+			}
+		}
+		if (Autotune.Active) {
+			ReadAutotuneTimestamps(CurrentFrame);
+			if (Autotune.Frame == AutotuneFrameCount) {
+				FinishAutotune();
+			}
+		}
 		glfwPollEvents();
+		UpdateSubstepCount();
+		UpdatePipelineVariant();
+		UpdateEngineAllocation();
 
 		VkResult AcquireImageResult = vkAcquireNextImageKHR(Device, Swapchain, UINT64_MAX, ImageAvailableSemaphores[CurrentFrame], VK_NULL_HANDLE, &ImageIndex);
 
@@ -558,30 +2296,95 @@ s32 main() {
 			CreateSwapchain();
 			CurrentFrame = 0;
 			FrameNumber = 0;
+			PresentedFrameNumber = 0;
 			continue;
 		} else {
 			RuntimeAssert(AcquireImageResult == VK_SUCCESS);
 		}
 
-		vkResetFences(Device, 1, InFlightFences + CurrentFrame);
+		u32 Engine = SimulationEngine;
+		if (Engine == SIMULATION_ENGINE_TILED && !Pipelines[PIPELINE_IDX_SIMULATE_TILED]) {
+			// the tiled pipeline is left out of variants whose halo does not fit in shared memory
+			Engine = SIMULATION_ENGINE_ROW_PREFIX_SUM;
+		}
+		// whether a multiple of the interval falls on one of this frame's substeps
+		u32 NextReorderFrame = (FrameNumber + ReorderInterval - 1) / ReorderInterval * ReorderInterval;
+		bool Reorder = ReorderParticles && NextReorderFrame < FrameNumber + SubstepCount;
+
+		// a reorder or compaction moves particles to other indices, and spawned ones have no counts yet,
+		// so the cached neighbor counts no longer line up
+		if (ResetParticleState || Reorder || SpawnRequested || DespawnRequested || Engine != SIMULATION_ENGINE_ROW_PREFIX_SUM) {
+			NeighborCountsValid = false;
+		}
+		bool StaggeredRefresh = Engine == SIMULATION_ENGINE_ROW_PREFIX_SUM && NeighborRefreshPeriod > 1;
+		if (RefreshErrorRequested && !StaggeredRefresh) {
+			printf("the neighbor counts are exact, select the row prefix sum engine and a refresh period with K\n");
+			RefreshErrorRequested = false;
+		}
+		// the stats buffer is shared by the frames in flight, so only one frame measures at a time
+		bool MeasureRefreshError = RefreshErrorRequested && !RefreshErrorPending && NeighborCountsValid;
+		if (MeasureRefreshError) {
+			RefreshErrorRequested = false;
+			RefreshErrorPending = true;
+			RefreshErrorTimelineValue = FrameTimelineValue + 1;
+		}
 
 		{
-			uniform_data *UniformData;
-			vkMapMemory(Device, GPUVisibleArena.Memory, 0, sizeof(uniform_data), 0, (void **)&UniformData);
-			UniformData->ImageSize.X = WindowWidth;
-			UniformData->ImageSize.Y = WindowHeight;
-			UniformData->ParticleCount = ParticleCount;
-			UniformData->FrameNumber = FrameNumber;
-			UniformData->DensityBufferLength = DensityBufferLength;
-			UniformData->DensityBufferWidth = DensityBufferWidth;
-			UniformData->DensityBufferHeight = DensityBufferHeight;
-			vkUnmapMemory(Device, GPUVisibleArena.Memory);
+			uniform_data UniformData = {};
+			UniformData.ImageSize.X = WindowWidth;
+			UniformData.ImageSize.Y = WindowHeight;
+			UniformData.FirstFrameNumber = FrameNumber;
+			UniformData.PresentedFrameNumber = PresentedFrameNumber;
+			UniformData.DensityBufferLength = DensityBufferLength;
+			UniformData.DensityBufferWidth = DensityBufferWidth;
+			UniformData.DensityBufferHeight = DensityBufferHeight;
+			UniformData.FftWidth = FftWidth;
+			UniformData.FftHeight = FftHeight;
+			UniformData.OccupancyRowWords = OccupancyRowWords;
+			UniformData.OccupancyBitmapLength = OccupancyBitmapLength;
+			UniformData.IncrementalDensity = DensityFieldHalves == 1;
+			UniformData.NeighborRefreshPeriod = StaggeredRefresh ? NeighborRefreshPeriod : 1;
+			UniformData.NeighborRefreshAll = !NeighborCountsValid;
+			UniformData.MeasureRefreshError = MeasureRefreshError;
+			UniformData.TrailTimestamps = TrailVisitLength != 0;
+			UniformData.SpawnCount = SPAWN_BATCH_SIZE;
+			UniformData.SpawnSeed = FrameNumber * SPAWN_BATCH_SIZE + 0x9E3779B9u;
+			UniformData.EditRegionX = EditRegion.X;
+			UniformData.EditRegionY = EditRegion.Y;
+			UniformData.EditRegionRadius = EDIT_REGION_RADIUS;
+			WriteUniformSlice(CurrentFrame, UniformData);
 		}
-
+		// a staggered frame recounts whatever is stale, so the whole cache is current afterwards
+		NeighborCountsValid = StaggeredRefresh;
+
+		bool FusedFadeAvailable = Engine == SIMULATION_ENGINE_ROW_PREFIX_SUM && DensityBufferLength != 0 &&
+			Pipelines[PIPELINE_IDX_ROW_PREFIX_SUM_FUSED];
+		bool FusedFade = FusedFadeAvailable && (Autotune.Active ? AutotuneFusedRound() : FuseClearAndFade);
+		// in trail mode the fade pass is only left with clearing the density field's write half
+		bool FadeNeeded = TrailVisitLength == 0 || (DensityBufferLength != 0 && DensityFieldHalves == 2);
+		// the last frame did not clear what it read, which is the half written this frame; a reset refills the whole field
+		bool ReadHalfCleared = DensityReadHalfCleared && !ResetParticleState;
+		bool ClearWriteHalf = (FusedFade || !FadeNeeded) && !ReadHalfCleared && DensityFieldHalves == 2;
+		DensityReadHalfCleared = FusedFade;
+		// the first fused frame after separate ones also clears its write half, which the fused path saves later on
+		bool TimeFadePath = Autotune.Active && FusedFadeAvailable && !(FusedFade && ClearWriteHalf);
+
+		bool SteadyFrame = !ResetParticleState && !ParticleDispatchStale && !SpawnRequested && !DespawnRequested && !Reorder &&
+			!Autotune.Active && !(Engine == SIMULATION_ENGINE_FFT && FftKernelsDirty) && !MeasureRefreshError;
 		VkCommandBuffer CommandBuffer = CommandBuffers[CurrentFrame];
-		{
+		bool RecordCommands = true;
+		if (SteadyFrame) {
+			frame_commands_key Key = { FrameCommandsGeneration, Engine, FusedFade, FadeNeeded, ClearWriteHalf, SubstepCount, FrameNumber & 0x1 };
+			u32 CacheIndex = ImageIndex * FramesInFlight + CurrentFrame;
+			CommandBuffer = CachedFrameCommands[CacheIndex];
+			// the last submit of this command buffer was from this slot, which has been waited on above
+			RecordCommands = memcmp(&Key, CachedFrameKeys + CacheIndex, sizeof(Key)) != 0;
+			CachedFrameKeys[CacheIndex] = Key;
+		}
+
+		if (RecordCommands) {
 			vkResetCommandBuffer(CommandBuffer, 0);
-			VulkanBeginCommands(CommandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+			VulkanBeginCommands(CommandBuffer, SteadyFrame ? 0 : VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
 			constexpr cmd_image_transition ComputeRWTransition =
 				{ VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT };
@@ -592,16 +2395,43 @@ s32 main() {
 			constexpr cmd_image_transition PresentTransition =
 				{ VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0 };
 
-			CmdTransitionImageLayout(CommandBuffer, OutputImage, TransferSrcTransition, ComputeRWTransition);
+			// the acquired image is overwritten in full, so its contents are discarded
+			constexpr cmd_image_transition PresentAcquireTransition =
+				{ VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0 };
+
+			if (Autotune.Active) {
+				vkCmdResetQueryPool(CommandBuffer, Autotune.QueryPool, AutotuneQueriesPerFrame * CurrentFrame, AutotuneQueriesPerFrame);
+			}
+
+			// the previous frame may still be running, and every pass of this one reads or writes what it left behind
+			CmdMemoryBarrier(CommandBuffer,
+				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT },
+				{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+				  VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+				  VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT }
+			);
 
-			vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, PipelineLayout, 0, 1, &DescriptorSet, 0, NULL);
+			vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, PipelineLayout, 0, 1, DescriptorSets + CurrentFrame, 0, NULL);
+			substep_constants SubstepConstants = { 0, SubstepCount - 1 };
+			vkCmdPushConstants(CommandBuffer, PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SubstepConstants), &SubstepConstants);
+			if (PresentDirect) {
+				vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, PipelineLayout, 1, 1, PresentDescriptorSets + ImageIndex, 0, NULL);
+				CmdTransitionImageLayout(CommandBuffer, SwapchainImages[ImageIndex], PresentAcquireTransition, ComputeRWTransition);
+			} else if (!AsyncCompute) {
+				CmdTransitionImageLayout(CommandBuffer, OutputImage, TransferSrcTransition, ComputeRWTransition);
+			}
 
-			// vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, ClearComputePipeline);
+			// vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_CLEAR]);
 			// vkCmdDispatch(CommandBuffer, (WindowWidth + 15) / 16, (WindowHeight + 15) / 16, 1);
 
+			// zeroed in queue order rather than from the host, which can't tell whether the GPU still writes the stats
+			if (MeasureRefreshError) {
+				CmdZeroBuffer(CommandBuffer, BufferHandles[BUFFER_IDX_REFRESH_ERRORS].buffer, 0, sizeof(refresh_error_stats));
+			}
+
 			if (ResetParticleState) {
-				vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, ClearComputePipeline);
-				vkCmdDispatch(CommandBuffer, (WindowWidth + 15) / 16, (WindowHeight + 15) / 16, 1);
+				vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_CLEAR]);
+				CmdDispatchImage(CommandBuffer);
 
 				VkBufferMemoryBarrier DensityFieldBarrier = {
 					.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
@@ -616,8 +2446,34 @@ s32 main() {
 					0, 0, NULL, 1, &DensityFieldBarrier, 0, NULL
 				);
 
-				vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, ResetComputePipeline);
-				vkCmdDispatch(CommandBuffer, (ParticleCount + 127) / 128, 1, 1);
+				if (TrailVisitLength != 0) {
+					CmdZeroBuffer(CommandBuffer, BufferHandles[BUFFER_IDX_TRAIL_VISITS].buffer, 0, sizeof(u32) * TrailVisitLength);
+				}
+
+				// the reset dispatch is the first to read the count, so it waits on the transfer
+				u32 TunedGroupCount = (ResetParticleCount + WorkgroupTuning.ParticleGroupSize - 1) / WorkgroupTuning.ParticleGroupSize;
+				particle_counter Counter = {
+					(ResetParticleCount + 127) / 128, 1, 1,
+					ResetParticleCount, ResetParticleCount, ResetParticleCount,
+					TunedGroupCount, 1, 1
+				};
+				VkBuffer CounterBuffer = BufferHandles[BUFFER_IDX_PARTICLE_COUNT].buffer;
+				vkCmdUpdateBuffer(CommandBuffer, CounterBuffer, 0, sizeof(Counter), &Counter);
+				CmdBufferMemoryBarrier(CommandBuffer, CounterBuffer,
+					{ VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT },
+					{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+					  VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+				);
+				ParticleCountBound = ResetParticleCount;
+
+				u32 ResetPipelineIndex = PIPELINE_IDX_RESET;
+				if (OccupancyRowWords != 0) {
+					CmdClearOccupancy(CommandBuffer, 0);
+					CmdClearOccupancy(CommandBuffer, 1);
+					ResetPipelineIndex = PIPELINE_IDX_RESET_BITMAP;
+				}
+				vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[ResetPipelineIndex]);
+				CmdDispatchParticles(CommandBuffer);
 
 				VkBuffer Buffers[] = {
 					BufferHandles[BUFFER_IDX_POSITION].buffer,
@@ -641,49 +2497,217 @@ s32 main() {
 				ResetParticleState = false;
 			}
 
-			vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, FadeComputePipeline);
-			vkCmdDispatch(CommandBuffer, (WindowWidth + 15) / 16, (WindowHeight + 15) / 16, 1);
-			CmdTransitionImageLayout(CommandBuffer, OutputImage, ComputeRWTransition, ComputeRWTransition);
-			CmdBufferMemoryBarrier(CommandBuffer, BufferHandles[BUFFER_IDX_DENSITY_FIELD].buffer,
-				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
-				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
-			);
-			vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, SimulateComputePipeline);
-			vkCmdDispatch(CommandBuffer, (ParticleCount + 127) / 128, 1, 1);
-			CmdBufferMemoryBarrier(CommandBuffer, BufferHandles[BUFFER_IDX_DENSITY_FIELD].buffer,
-				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
-				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
-			);
+			if (ParticleDispatchStale) {
+				CmdUpdateParticleCount(CommandBuffer);
+				ParticleDispatchStale = false;
+			}
+
+			if (SpawnRequested) {
+				CmdSpawnParticles(CommandBuffer);
+				SpawnRequested = false;
+			}
+			if (DespawnRequested) {
+				CmdDespawnParticles(CommandBuffer);
+				DespawnRequested = false;
+			}
+
+			if (Reorder) {
+				CmdReorderParticles(CommandBuffer);
+			}
+
+			for (u32 Substep = 0; Substep < SubstepCount; ++Substep) {
+				if (Substep != 0) {
+					SubstepConstants.Substep = Substep;
+					vkCmdPushConstants(CommandBuffer, PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SubstepConstants), &SubstepConstants);
+				}
+				u32 StepNumber = FrameNumber + Substep;
+				// the substeps before this one cleared their read half exactly when they were fused
+				bool ClearHalf = (Substep == 0) ? ClearWriteHalf : !FusedFade && !FadeNeeded && DensityFieldHalves == 2;
+
+				if (TimeFadePath) {
+					CmdAutotuneFadePathBegin(CommandBuffer, CurrentFrame);
+				}
+				if (!FusedFade && FadeNeeded) {
+					if (Autotune.Active) {
+						CmdAutotuneFade(CommandBuffer, CurrentFrame);
+					} else {
+						vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_FADE]);
+						CmdDispatchTunedImage(CommandBuffer);
+					}
+					CmdTransitionImageLayout(CommandBuffer, OutputImage, ComputeRWTransition, ComputeRWTransition);
+					CmdBufferMemoryBarrier(CommandBuffer, BufferHandles[BUFFER_IDX_DENSITY_FIELD].buffer,
+						{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+						{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+					);
+				} else if (ClearHalf) {
+					VkDeviceSize HalfSize = sizeof(u32) * DensityBufferLength;
+					VkDeviceSize WriteOffset = bool(StepNumber & 0x1) ? HalfSize : 0;
+					CmdZeroBuffer(CommandBuffer, BufferHandles[BUFFER_IDX_DENSITY_FIELD].buffer, WriteOffset, HalfSize);
+				}
+
+				switch (Engine) {
+					case SIMULATION_ENGINE_ROW_PREFIX_SUM: {
+						if (FusedFade) {
+							// one barrier covers the prefix sums, the cleared read half and the faded image
+							vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_ROW_PREFIX_SUM_FUSED]);
+							vkCmdDispatch(CommandBuffer, DensityBufferHeight, 1, 1);
+							CmdMemoryBarrier(CommandBuffer,
+								{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+								{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+							);
+						} else {
+							vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_ROW_PREFIX_SUM]);
+							vkCmdDispatch(CommandBuffer, DensityBufferHeight, 1, 1);
+							CmdBufferMemoryBarrier(CommandBuffer, BufferHandles[BUFFER_IDX_ROW_PREFIX_SUM].buffer,
+								{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+								{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT }
+							);
+						}
+						if (TimeFadePath) {
+							CmdAutotuneFadePathEnd(CommandBuffer, CurrentFrame, FusedFade);
+						}
+						if (Autotune.Active) {
+							CmdAutotuneSimulate(CommandBuffer, CurrentFrame);
+						} else {
+							vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_SIMULATE]);
+							CmdDispatchTunedParticles(CommandBuffer);
+						}
+					} break;
+					case SIMULATION_ENGINE_TILED: {
+						CmdCountAndScanBins(CommandBuffer, PIPELINE_IDX_BIN_PARTICLES, PIPELINE_IDX_SCAN_BINS);
+						CmdScatterBins(CommandBuffer, PIPELINE_IDX_SCATTER_BINS);
+						vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_SIMULATE_TILED]);
+						vkCmdDispatch(CommandBuffer, TileCountX, TileCountY, 1);
+					} break;
+					case SIMULATION_ENGINE_CELL_LIST: {
+						CmdCountAndScanBins(CommandBuffer, PIPELINE_IDX_BIN_PARTICLES_CELLS, PIPELINE_IDX_SCAN_BINS_CELLS);
+						CmdScatterBins(CommandBuffer, PIPELINE_IDX_SCATTER_BINS_CELLS);
+						vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_SIMULATE_CELL_LIST]);
+						CmdDispatchParticles(CommandBuffer);
+					} break;
+					case SIMULATION_ENGINE_FFT: {
+						CmdConvolveDensityField(CommandBuffer);
+						vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_SIMULATE_FFT]);
+						CmdDispatchParticles(CommandBuffer);
+					} break;
+					case SIMULATION_ENGINE_BITMAP: {
+						CmdClearOccupancy(CommandBuffer, bool(StepNumber & 0x1) ? 1 : 0);
+						vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_SIMULATE_BITMAP]);
+						CmdDispatchParticles(CommandBuffer);
+					} break;
+				}
+				if (DensityFieldHalves == 1 && DensityBufferLength != 0) {
+					// the simulate kernels only read the density field, so once they are done the moved particles can update it
+					VkBuffer StepOutputs[] = {
+						BufferHandles[BUFFER_IDX_POSITION].buffer,
+						BufferHandles[BUFFER_IDX_MOVED_FROM_CELLS].buffer,
+						BufferHandles[BUFFER_IDX_DENSITY_FIELD].buffer,
+					};
+					for (u32 i = 0; i < ArrayLen(StepOutputs); ++i) {
+						CmdBufferMemoryBarrier(CommandBuffer, StepOutputs[i],
+							{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT },
+							{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+						);
+					}
+					vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_UPDATE_DENSITY]);
+					CmdDispatchParticles(CommandBuffer);
+				}
+				// the next substep's or frame's fade shades from the density field or occupancy bitmap written here
+				CmdMemoryBarrier(CommandBuffer,
+					{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+					{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
+				);
+			}
+			if (TrailVisitLength != 0) {
+				vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_PRESENT_TRAILS]);
+				CmdDispatchImage(CommandBuffer);
+			}
 #if 0
-			vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, RenderDensityBufferComputePipeline);
-			vkCmdDispatch(CommandBuffer, (WindowWidth + 15) / 16, (WindowHeight + 15) / 16, 1);
+			vkCmdBindPipeline(CommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, Pipelines[PIPELINE_IDX_RENDER_DENSITY_BUFFER]);
+			CmdDispatchImage(CommandBuffer);
 			CmdBufferMemoryBarrier(CommandBuffer, BufferHandles[BUFFER_IDX_DENSITY_FIELD].buffer,
 				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
 				{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT }
 			);
 #endif
 
-			CmdTransitionImageLayout(CommandBuffer, OutputImage, ComputeRWTransition, TransferSrcTransition);
-			CmdTransitionImageLayout(CommandBuffer, SwapchainImages[ImageIndex], PresentTransition, TransferDstTransition);
-			v2i Resolution = { WindowWidth, WindowHeight };
-			CmdBlit2DImage(CommandBuffer, OutputImage, SwapchainImages[ImageIndex], Resolution, Resolution);
-			CmdTransitionImageLayout(CommandBuffer, SwapchainImages[ImageIndex], TransferDstTransition, PresentTransition);
+			if (PresentDirect) {
+				CmdTransitionImageLayout(CommandBuffer, SwapchainImages[ImageIndex], ComputeRWTransition, PresentTransition);
+			} else if (AsyncCompute) {
+				CmdCopyToFrameImage(CommandBuffer, CurrentFrame);
+			} else {
+				CmdTransitionImageLayout(CommandBuffer, OutputImage, ComputeRWTransition, TransferSrcTransition);
+				CmdTransitionImageLayout(CommandBuffer, SwapchainImages[ImageIndex], PresentTransition, TransferDstTransition);
+				v2i Resolution = { WindowWidth, WindowHeight };
+				CmdBlit2DImage(CommandBuffer, OutputImage, SwapchainImages[ImageIndex], Resolution, Resolution);
+				CmdTransitionImageLayout(CommandBuffer, SwapchainImages[ImageIndex], TransferDstTransition, PresentTransition);
+			}
+
+			// waiting on the timeline semaphore does not make the stats visible to PrintRefreshError on its own
+			if (MeasureRefreshError) {
+				CmdBufferMemoryBarrier(CommandBuffer, BufferHandles[BUFFER_IDX_REFRESH_ERRORS].buffer,
+					{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT },
+					{ VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT }
+				);
+			}
 
 			VulkanEndCommands(CommandBuffer);
+			if (Autotune.Active) {
+				Autotune.Frame += 1;
+			}
 		}
 
-		VkPipelineStageFlags WaitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+		// the direct path writes the acquired image from compute shaders, which have to wait for it
+		VkSemaphore WaitSemaphores[] = { ImageAvailableSemaphores[CurrentFrame], ComputeFinishedSemaphores[CurrentFrame] };
+		VkPipelineStageFlags WaitStages[] = {
+			PresentDirect ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT
+		};
+		VkCommandBuffer GraphicsCommandBuffer = CommandBuffer;
+		if (AsyncCompute) {
+			// the simulation goes to the compute queue, and only the blit of its result waits for the swapchain image
+			VkSubmitInfo ComputeSubmitInfo = {
+				.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+				.commandBufferCount = 1,
+				.pCommandBuffers = &CommandBuffer,
+				.signalSemaphoreCount = 1,
+				.pSignalSemaphores = ComputeFinishedSemaphores + CurrentFrame,
+			};
+			RuntimeAssert(vkQueueSubmit(ComputeQueue, 1, &ComputeSubmitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
+
+			u32 BlitIndex = ImageIndex * FramesInFlight + CurrentFrame;
+			GraphicsCommandBuffer = BlitCommands[BlitIndex];
+			if (BlitCommandGenerations[BlitIndex] != FrameCommandsGeneration) {
+				vkResetCommandBuffer(GraphicsCommandBuffer, 0);
+				VulkanBeginCommands(GraphicsCommandBuffer, 0);
+				CmdBlitFrameImage(GraphicsCommandBuffer, CurrentFrame, ImageIndex);
+				VulkanEndCommands(GraphicsCommandBuffer);
+				BlitCommandGenerations[BlitIndex] = FrameCommandsGeneration;
+			}
+			WaitStages[0] = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		}
+		// the binary semaphore for presentation ignores its value
+		FrameTimelineValue += 1;
+		FrameTimelineValues[CurrentFrame] = FrameTimelineValue;
+		VkSemaphore SignalSemaphores[] = { RenderFinishedSemaphores[CurrentFrame], FrameTimeline };
+		u64 SignalValues[] = { 0, FrameTimelineValue };
+		VkTimelineSemaphoreSubmitInfo TimelineSubmitInfo = {
+			.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+			.signalSemaphoreValueCount = ArrayLen(SignalValues),
+			.pSignalSemaphoreValues = SignalValues
+		};
 		VkSubmitInfo SubmitInfo = {
 			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.waitSemaphoreCount = 1,
-			.pWaitSemaphores = ImageAvailableSemaphores + CurrentFrame,
+			.pNext = &TimelineSubmitInfo,
+			.waitSemaphoreCount = AsyncCompute ? 2u : 1u,
+			.pWaitSemaphores = WaitSemaphores,
 			.pWaitDstStageMask = WaitStages,
 			.commandBufferCount = 1,
-			.pCommandBuffers = &CommandBuffer,
-			.signalSemaphoreCount = 1,
-			.pSignalSemaphores = RenderFinishedSemaphores + CurrentFrame,
+			.pCommandBuffers = &GraphicsCommandBuffer,
+			.signalSemaphoreCount = ArrayLen(SignalSemaphores),
+			.pSignalSemaphores = SignalSemaphores,
 		};
-		RuntimeAssert(vkQueueSubmit(Queue, 1, &SubmitInfo, InFlightFences[CurrentFrame]) == VK_SUCCESS);
+		RuntimeAssert(vkQueueSubmit(Queue, 1, &SubmitInfo, VK_NULL_HANDLE) == VK_SUCCESS);
 
 		VkPresentInfoKHR PresentInfo = {};
 		PresentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -699,12 +2723,14 @@ s32 main() {
 			CreateSwapchain();
 			CurrentFrame = 0;
 			FrameNumber = 0;
+			PresentedFrameNumber = 0;
 			continue;
 		}
 
 		CurrentFrame += 1;
 		CurrentFrame %= FramesInFlight;
-		FrameNumber += 1;
+		FrameNumber += SubstepCount;
+		PresentedFrameNumber += 1;
 	}
 
 	vkDeviceWaitIdle(Device);
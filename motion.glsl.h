@@ -0,0 +1,83 @@
+// The particle motion law, shared by every simulate kernel
+
+float deg2rad(float degrees) {
+    return degrees * 0.017453292519943295; // π / 180
+}
+
+// sin of a binary angle, scaled by 1 << SINE_TABLE_BITS; the table holds the first quadrant without its last entry
+int fixed_sine(uint heading) {
+	const uint quarter = 1u << SINE_TABLE_BITS;
+	uint quadrant = (heading >> SINE_TABLE_BITS) & 3u;
+	uint i = heading & (quarter - 1u);
+	int value;
+	if ((quadrant & 1u) == 0) {
+		value = SineTable[i];
+	} else {
+		value = (i == 0) ? int(quarter) : SineTable[quarter - i];
+	}
+	return (quadrant >= 2) ? -value : value;
+}
+
+ivec2 fixed_direction(uint heading) {
+	return ivec2(fixed_sine(heading + (1u << SINE_TABLE_BITS)), fixed_sine(heading));
+}
+
+// Direction of a heading as stored in Angles. With FIXED_POINT_MOTION it is scaled by 1 << SINE_TABLE_BITS
+// and integer valued, which the sensing code relies on to split the disc exactly.
+vec2 heading_direction(float angle) {
+#if FIXED_POINT_MOTION
+	return vec2(fixed_direction(uint(angle)));
+#else
+	return vec2(cos(angle), sin(angle));
+#endif
+}
+
+// Turns the particle by the motion law, moves it one step and deposits it into this frame's density field.
+// With IncrementalDensity it only records the cell it leaves, and update_density moves its count after the step.
+void step_particle(uint idx, vec2 position, float angle, int left, int right) {
+	ivec2 previous_cell = ivec2(position / DensityBufferDownscale);
+
+#if FIXED_POINT_MOTION
+	// integer steps wrap by at most one image size; multiplying by powers of two keeps the float conversions exact
+	const float fixed_scale = float(1 << FIXED_POSITION_BITS);
+	int turn = FixedAlpha + FixedBeta * (left + right) * sign(right - left);
+	uint heading = (uint(angle) - uint(turn)) & ((1u << FIXED_ANGLE_BITS) - 1u);
+	const int step_shift = SINE_TABLE_BITS - FIXED_POSITION_BITS;
+	ivec2 step = (fixed_direction(heading) + (1 << (step_shift - 1))) >> step_shift;
+
+	ivec2 fixed_size = ImageSize << FIXED_POSITION_BITS;
+	ivec2 fixed_position = ivec2(position * fixed_scale) + step;
+	fixed_position += mix(ivec2(0), fixed_size, lessThan(fixed_position, ivec2(0)));
+	fixed_position -= mix(ivec2(0), fixed_size, greaterThanEqual(fixed_position, fixed_size));
+	position = vec2(fixed_position) * (1.0 / fixed_scale);
+	angle = float(heading);
+#else
+	float alpha = deg2rad(Alpha);
+	float beta = deg2rad(Beta);
+	float count = float(left + right);
+	angle -= alpha + beta * count * sign(right - left);
+	vec2 direction = vec2(cos(angle), sin(angle));
+
+	position = mod(position + direction, vec2(ImageSize.x, ImageSize.y));
+#endif
+	store_particle(idx, position, angle);
+
+	// in fast-forward mode the intermediate substeps leave no trail
+	if (TrailTimestamps != 0 && presented_substep()) {
+		ivec2 pixel = min(ivec2(position), ImageSize - 1);
+		TrailVisits[pixel.y * ImageSize.x + pixel.x] = PresentedFrameNumber + 1;
+	}
+
+	{
+		ivec2 rounded_pos = ivec2(position / DensityBufferDownscale);
+#ifdef OCCUPANCY_BITMAP
+		deposit_occupancy(bool(frame_number() & 0x1) ? 1 : 0, rounded_pos);
+#else
+		if (IncrementalDensity != 0) {
+			MovedFromCells[idx] = density_index(previous_cell);
+		} else {
+			deposit_density(density_write_offset() + density_index(rounded_pos));
+		}
+#endif
+	}
+}
@@ -0,0 +1,86 @@
+// Occupancy bitmap, which the bitmap engine uses in place of the density field.
+// Each half of OccupancyBitmap holds one bit per cell, with every row padded to OccupancyRowWords words.
+// Only the first particle in a cell sets its bit. Any further particle sets the bit of its bitmap word in
+// OccupancyOverflowFlags and counts itself in OccupancyOverflow, an open addressing table of
+// OCCUPANCY_OVERFLOW_CAPACITY (key + 1, extra particles) pairs keyed by the cell's bit index.
+// Half 1 of each buffer directly follows half 0.
+
+uint occupancy_flag_words() {
+	return (OccupancyBitmapLength + 31) / 32;
+}
+
+uint occupancy_overflow_slot(uint key) {
+	return (key * 2654435761u) >> (32 - OCCUPANCY_OVERFLOW_BITS);
+}
+
+void occupancy_overflow_add(uint table_offset, uint key) {
+	uint slot = occupancy_overflow_slot(key);
+	for (uint probe = 0; probe < OCCUPANCY_OVERFLOW_CAPACITY; ++probe) {
+		uint entry = table_offset + 2 * slot;
+		uint stored = atomicCompSwap(OccupancyOverflow[entry], 0u, key + 1);
+		if (stored == 0u || stored == key + 1) {
+			atomicAdd(OccupancyOverflow[entry + 1], 1u);
+			return;
+		}
+		slot = (slot + 1) & (OCCUPANCY_OVERFLOW_CAPACITY - 1);
+	}
+}
+
+uint occupancy_overflow_count(uint table_offset, uint key) {
+	uint slot = occupancy_overflow_slot(key);
+	for (uint probe = 0; probe < OCCUPANCY_OVERFLOW_CAPACITY; ++probe) {
+		uint entry = table_offset + 2 * slot;
+		uint stored = OccupancyOverflow[entry];
+		if (stored == key + 1) {
+			return OccupancyOverflow[entry + 1];
+		}
+		if (stored == 0u) {
+			break;
+		}
+		slot = (slot + 1) & (OCCUPANCY_OVERFLOW_CAPACITY - 1);
+	}
+	return 0;
+}
+
+// Adds one particle to the cell in half parity (0 or 1) of the occupancy buffers
+void deposit_occupancy(uint parity, ivec2 cell) {
+	uint key = uint(cell.y) * OccupancyRowWords * 32 + uint(cell.x);
+	uint word = key >> 5;
+	uint bit = 1u << (key & 31);
+	if ((atomicOr(OccupancyBitmap[parity * OccupancyBitmapLength + word], bit) & bit) == 0) {
+		return;
+	}
+	atomicOr(OccupancyOverflowFlags[parity * occupancy_flag_words() + (word >> 5)], 1u << (word & 31));
+	occupancy_overflow_add(parity * 2 * OCCUPANCY_OVERFLOW_CAPACITY, key);
+}
+
+// Counts the particles in the cells first..last (inclusive) of one row in half parity, with 0 <= first <= last < width.
+// Each covered word takes one masked bitCount. The overflow table is only probed for occupied cells of words
+// whose overflow flag is set.
+int occupancy_span_count(uint parity, int row, int first, int last) {
+	uint row_word = uint(row) * OccupancyRowWords;
+	uint bitmap_offset = parity * OccupancyBitmapLength;
+	uint flag_offset = parity * occupancy_flag_words();
+	uint table_offset = parity * 2 * OCCUPANCY_OVERFLOW_CAPACITY;
+
+	int count = 0;
+	for (int w = first >> 5; w <= last >> 5; ++w) {
+		uint mask = ~0u;
+		if (w == first >> 5) {
+			mask &= ~0u << (first & 31);
+		}
+		if (w == last >> 5) {
+			mask &= ~0u >> (31 - (last & 31));
+		}
+		uint word = row_word + uint(w);
+		uint bits = OccupancyBitmap[bitmap_offset + word] & mask;
+		count += bitCount(bits);
+
+		if (bits != 0 && (OccupancyOverflowFlags[flag_offset + (word >> 5)] & (1u << (word & 31))) != 0) {
+			for (; bits != 0; bits &= bits - 1) {
+				count += int(occupancy_overflow_count(table_offset, word * 32 + uint(findLSB(bits))));
+			}
+		}
+	}
+	return count;
+}
@@ -0,0 +1,39 @@
+#version 450
+#include "shared_constants.h"
+// the shape is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_IMAGE_GROUP_WIDTH, local_size_y_id = SPEC_ID_IMAGE_GROUP_HEIGHT) in;
+#include "bindings.glsl.h"
+
+// Trail mode: draws every pixel from the frame a particle last stepped onto it. The brightness is computed from the
+// age as TRAIL_DECAY^age, so nothing is faded between visits and the image is written, never read.
+// Visits are stamped with PresentedFrameNumber by the presented substep, so the age is counted in presented frames
+// whatever the substep count was when they were stamped.
+void main() {
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+
+	if (texel.x >= ImageSize.x || texel.y >= ImageSize.y) {
+		return;
+	}
+
+	ivec2 pixel = flip_y(texel);
+	uint visit = TrailVisits[pixel.y * ImageSize.x + pixel.x];
+
+	vec4 value = vec4(0.0, 0.0, 0.0, 1.0);
+	if (visit != 0) {
+		// Unsigned subtraction gives the right age across a wrap of the stamps, as long as the visit is less than
+		// 2^32 frames old; trails are black long before that. Fast-forward doesn't bring the wrap closer, since
+		// the stamps count presented frames, not substeps. A stamp that wraps to exactly 0 reads as unvisited for
+		// one frame.
+		uint age = PresentedFrameNumber + 1 - visit;
+		value.x = pow(TRAIL_DECAY, float(age));
+		value.x *= step(TRAIL_CUTOFF, value.x);
+		value.y = (age == 0) ? 1.0 : 0.0;
+	}
+
+	// nothing reads the image back, so with PRESENT_DIRECT it is skipped
+#ifdef PRESENT_DIRECT
+	present_texel(texel, value);
+#else
+	imageStore(OutputImage, texel, value);
+#endif
+}
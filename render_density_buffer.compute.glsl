@@ -1,8 +1,8 @@
 #version 450
-layout(local_size_x = 16, local_size_y = 16) in;
-
-#include "bindings.glsl.h"
 #include "shared_constants.h"
+// the shape is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_IMAGE_GROUP_WIDTH, local_size_y_id = SPEC_ID_IMAGE_GROUP_HEIGHT) in;
+#include "bindings.glsl.h"
 
 void main() {
 	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
@@ -11,11 +11,11 @@ void main() {
 		return;
 	}
 
-	uint read_offset = bool(FrameNumber & 0x1) ? DensityBufferLength : 0;
+	// the half this frame's step deposited into
+	uint read_offset = density_write_offset();
 
-	ivec2 position = ivec2(texel / DENSITY_BUFFER_DOWNSCALE);
-	uint index = position.y * DensityBufferWidth + position.x;
-	uint particle_count = DensityField[read_offset + index];
+	ivec2 position = ivec2(texel / DensityBufferDownscale);
+	uint particle_count = DensityField[read_offset + density_index(position)];
 
 	vec4 color = imageLoad(OutputImage, flip_y(texel));
 	color.r = float(particle_count) / 4.0;
@@ -1,134 +0,0 @@
-{0x07230203,0x00010000,0x000d000b,0x000000b5,
-0x00000000,0x00020011,0x00000001,0x0006000b,
-0x00000001,0x4c534c47,0x6474732e,0x3035342e,
-0x00000000,0x0003000e,0x00000000,0x00000001,
-0x0006000f,0x00000005,0x00000004,0x6e69616d,
-0x00000000,0x00000023,0x00060010,0x00000004,
-0x00000011,0x00000010,0x00000010,0x00000001,
-0x00050048,0x0000000e,0x00000000,0x00000023,
-0x00000000,0x00050048,0x0000000e,0x00000001,
-0x00000023,0x00000008,0x00050048,0x0000000e,
-0x00000002,0x00000023,0x0000000c,0x00050048,
-0x0000000e,0x00000003,0x00000023,0x00000010,
-0x00050048,0x0000000e,0x00000004,0x00000023,
-0x00000014,0x00050048,0x0000000e,0x00000005,
-0x00000023,0x00000018,0x00030047,0x0000000e,
-0x00000002,0x00040047,0x00000010,0x00000022,
-0x00000000,0x00040047,0x00000010,0x00000021,
-0x00000001,0x00040047,0x00000023,0x0000000b,
-0x0000001c,0x00040047,0x0000005f,0x00000006,
-0x00000004,0x00050048,0x00000060,0x00000000,
-0x00000023,0x00000000,0x00030047,0x00000060,
-0x00000003,0x00040047,0x00000062,0x00000022,
-0x00000000,0x00040047,0x00000062,0x00000021,
-0x00000004,0x00040047,0x0000006e,0x00000022,
-0x00000000,0x00040047,0x0000006e,0x00000021,
-0x00000000,0x00040047,0x00000080,0x0000000b,
-0x00000019,0x00020013,0x00000002,0x00030021,
-0x00000003,0x00000002,0x00040015,0x00000006,
-0x00000020,0x00000001,0x00040017,0x00000007,
-0x00000006,0x00000002,0x00040015,0x0000000d,
-0x00000020,0x00000000,0x0008001e,0x0000000e,
-0x00000007,0x0000000d,0x0000000d,0x0000000d,
-0x0000000d,0x0000000d,0x00040020,0x0000000f,
-0x00000002,0x0000000e,0x0004003b,0x0000000f,
-0x00000010,0x00000002,0x0004002b,0x00000006,
-0x00000011,0x00000000,0x0004002b,0x0000000d,
-0x00000012,0x00000001,0x00040020,0x00000013,
-0x00000002,0x00000006,0x0004002b,0x00000006,
-0x00000016,0x00000001,0x00040017,0x00000021,
-0x0000000d,0x00000003,0x00040020,0x00000022,
-0x00000001,0x00000021,0x0004003b,0x00000022,
-0x00000023,0x00000001,0x00040017,0x00000024,
-0x0000000d,0x00000002,0x00020014,0x00000028,
-0x0004002b,0x0000000d,0x00000029,0x00000000,
-0x0004002b,0x00000006,0x0000003d,0x00000002,
-0x00040020,0x0000003e,0x00000002,0x0000000d,
-0x0004002b,0x00000006,0x00000046,0x00000003,
-0x0004002b,0x00000006,0x00000056,0x00000004,
-0x0003001d,0x0000005f,0x0000000d,0x0003001e,
-0x00000060,0x0000005f,0x00040020,0x00000061,
-0x00000002,0x00000060,0x0004003b,0x00000061,
-0x00000062,0x00000002,0x00030016,0x00000068,
-0x00000020,0x00040017,0x00000069,0x00000068,
-0x00000004,0x00090019,0x0000006c,0x00000068,
-0x00000001,0x00000000,0x00000000,0x00000000,
-0x00000002,0x00000004,0x00040020,0x0000006d,
-0x00000000,0x0000006c,0x0004003b,0x0000006d,
-0x0000006e,0x00000000,0x0004002b,0x0000000d,
-0x0000007f,0x00000010,0x0006002c,0x00000021,
-0x00000080,0x0000007f,0x0000007f,0x00000012,
-0x0005002c,0x00000007,0x000000b3,0x00000016,
-0x00000016,0x0004002b,0x00000068,0x000000b4,
-0x3e800000,0x00050036,0x00000002,0x00000004,
-0x00000000,0x00000003,0x000200f8,0x00000005,
-0x000300f7,0x0000008c,0x00000000,0x000300fb,
-0x00000029,0x0000008d,0x000200f8,0x0000008d,
-0x0004003d,0x00000021,0x00000025,0x00000023,
-0x0007004f,0x00000024,0x00000026,0x00000025,
-0x00000025,0x00000000,0x00000001,0x0004007c,
-0x00000007,0x00000027,0x00000026,0x00050051,
-0x00000006,0x0000002b,0x00000027,0x00000000,
-0x00060041,0x00000013,0x0000002c,0x00000010,
-0x00000011,0x00000029,0x0004003d,0x00000006,
-0x0000002d,0x0000002c,0x000500af,0x00000028,
-0x0000002e,0x0000002b,0x0000002d,0x000400a8,
-0x00000028,0x0000002f,0x0000002e,0x000300f7,
-0x00000031,0x00000000,0x000400fa,0x0000002f,
-0x00000030,0x00000031,0x000200f8,0x00000030,
-0x00050051,0x00000006,0x00000033,0x00000027,
-0x00000001,0x00060041,0x00000013,0x00000034,
-0x00000010,0x00000011,0x00000012,0x0004003d,
-0x00000006,0x00000035,0x00000034,0x000500af,
-0x00000028,0x00000036,0x00000033,0x00000035,
-0x000200f9,0x00000031,0x000200f8,0x00000031,
-0x000700f5,0x00000028,0x00000037,0x0000002e,
-0x0000008d,0x00000036,0x00000030,0x000300f7,
-0x00000039,0x00000000,0x000400fa,0x00000037,
-0x00000038,0x00000039,0x000200f8,0x00000038,
-0x000200f9,0x0000008c,0x000200f8,0x00000039,
-0x00050041,0x0000003e,0x0000003f,0x00000010,
-0x0000003d,0x0004003d,0x0000000d,0x00000040,
-0x0000003f,0x000500c7,0x0000000d,0x00000041,
-0x00000040,0x00000012,0x000500ab,0x00000028,
-0x00000042,0x00000041,0x00000029,0x000300f7,
-0x00000045,0x00000000,0x000400fa,0x00000042,
-0x00000044,0x00000049,0x000200f8,0x00000044,
-0x00050041,0x0000003e,0x00000047,0x00000010,
-0x00000046,0x0004003d,0x0000000d,0x00000048,
-0x00000047,0x000200f9,0x00000045,0x000200f8,
-0x00000049,0x000200f9,0x00000045,0x000200f8,
-0x00000045,0x000700f5,0x0000000d,0x000000b2,
-0x00000048,0x00000044,0x00000029,0x00000049,
-0x00050087,0x00000007,0x0000004e,0x00000027,
-0x000000b3,0x00050051,0x00000006,0x00000054,
-0x0000004e,0x00000001,0x0004007c,0x0000000d,
-0x00000055,0x00000054,0x00050041,0x0000003e,
-0x00000057,0x00000010,0x00000056,0x0004003d,
-0x0000000d,0x00000058,0x00000057,0x00050084,
-0x0000000d,0x00000059,0x00000055,0x00000058,
-0x00050051,0x00000006,0x0000005b,0x0000004e,
-0x00000000,0x0004007c,0x0000000d,0x0000005c,
-0x0000005b,0x00050080,0x0000000d,0x0000005d,
-0x00000059,0x0000005c,0x00050080,0x0000000d,
-0x00000065,0x000000b2,0x0000005d,0x00060041,
-0x0000003e,0x00000066,0x00000062,0x00000011,
-0x00000065,0x0004003d,0x0000000d,0x00000067,
-0x00000066,0x0004003d,0x0000006c,0x0000006f,
-0x0000006e,0x00060041,0x00000013,0x00000094,
-0x00000010,0x00000011,0x00000012,0x0004003d,
-0x00000006,0x00000095,0x00000094,0x00050082,
-0x00000006,0x00000096,0x00000095,0x00000016,
-0x00050051,0x00000006,0x00000098,0x00000027,
-0x00000001,0x00050082,0x00000006,0x00000099,
-0x00000096,0x00000098,0x00060052,0x00000007,
-0x000000ac,0x00000099,0x00000027,0x00000001,
-0x00050062,0x00000069,0x00000073,0x0000006f,
-0x000000ac,0x00040070,0x00000068,0x00000075,
-0x00000067,0x00050085,0x00000068,0x00000077,
-0x00000075,0x000000b4,0x00060052,0x00000069,
-0x000000ae,0x00000077,0x00000073,0x00000000,
-0x0004003d,0x0000006c,0x0000007a,0x0000006e,
-0x00040063,0x0000007a,0x000000ac,0x000000ae,
-0x000200f9,0x0000008c,0x000200f8,0x0000008c,
-0x000100fd,0x00010038}
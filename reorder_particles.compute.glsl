@@ -0,0 +1,29 @@
+#version 450
+layout(local_size_x = 128) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "binning.glsl.h"
+
+// Counting sort scatter: after bin_particles and scan_bins ran with BIN_KEY_MORTON, every particle
+// moves to its bin's range, so particles that are close on screen end up close in memory
+void main() {
+	uint idx = gl_GlobalInvocationID.x;
+
+	if (idx >= ParticleCount) {
+		return;
+	}
+
+	vec2 position = load_position(idx);
+	uint destination = Bins[particle_bin(position)] + ParticleBinSlots[idx];
+
+#if PACKED_PARTICLES
+	ReorderedParticles[destination] = Particles[idx];
+#else
+	ReorderedPositions[destination] = position;
+	ReorderedAngles[destination] = Angles[idx];
+#endif
+#if TRACK_PARTICLE_IDS
+	ReorderedParticleIds[destination] = ParticleIds[idx];
+#endif
+}
@@ -1,8 +1,9 @@
 #version 450
 layout(local_size_x = 128) in;
 
-#include "bindings.glsl.h"
 #include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "occupancy.glsl.h"
 
 void main() {
 	uint idx = gl_GlobalInvocationID.x;
@@ -14,9 +15,15 @@ void main() {
 	uint random_seed = init_seed(idx);
 
 	vec2 position = random_vec2(random_seed) * vec2(ImageSize.x, ImageSize.y);
-	Positions[idx] = position;
-	Angles[idx] = random(random_seed) * TWO_PI;
+	position = store_new_particle(idx, position, random_seed);
+#if TRACK_PARTICLE_IDS
+	ParticleIds[idx] = idx;
+#endif
 
-	ivec2 index = ivec2(position / DENSITY_BUFFER_DOWNSCALE);
-	atomicAdd(DensityField[index.y * DensityBufferWidth + index.x], 1u);
+	ivec2 index = ivec2(position / DensityBufferDownscale);
+#ifdef OCCUPANCY_BITMAP
+	deposit_occupancy(0, index);
+#else
+	deposit_density(density_index(index));
+#endif
 }
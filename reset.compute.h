@@ -1,184 +0,0 @@
-{0x07230203,0x00010000,0x000d000b,0x0000014d,
-0x00000000,0x00020011,0x00000001,0x0006000b,
-0x00000001,0x4c534c47,0x6474732e,0x3035342e,
-0x00000000,0x0003000e,0x00000000,0x00000001,
-0x0006000f,0x00000005,0x00000004,0x6e69616d,
-0x00000000,0x00000075,0x00060010,0x00000004,
-0x00000011,0x00000080,0x00000001,0x00000001,
-0x00040047,0x00000075,0x0000000b,0x0000001c,
-0x00050048,0x0000007b,0x00000000,0x00000023,
-0x00000000,0x00050048,0x0000007b,0x00000001,
-0x00000023,0x00000008,0x00050048,0x0000007b,
-0x00000002,0x00000023,0x0000000c,0x00050048,
-0x0000007b,0x00000003,0x00000023,0x00000010,
-0x00050048,0x0000007b,0x00000004,0x00000023,
-0x00000014,0x00050048,0x0000007b,0x00000005,
-0x00000023,0x00000018,0x00030047,0x0000007b,
-0x00000002,0x00040047,0x0000007d,0x00000022,
-0x00000000,0x00040047,0x0000007d,0x00000021,
-0x00000001,0x00040047,0x0000009a,0x00000006,
-0x00000008,0x00050048,0x0000009b,0x00000000,
-0x00000023,0x00000000,0x00030047,0x0000009b,
-0x00000003,0x00040047,0x0000009d,0x00000022,
-0x00000000,0x00040047,0x0000009d,0x00000021,
-0x00000002,0x00040047,0x000000a2,0x00000006,
-0x00000004,0x00050048,0x000000a3,0x00000000,
-0x00000023,0x00000000,0x00030047,0x000000a3,
-0x00000003,0x00040047,0x000000a5,0x00000022,
-0x00000000,0x00040047,0x000000a5,0x00000021,
-0x00000003,0x00040047,0x000000b6,0x00000006,
-0x00000004,0x00050048,0x000000b7,0x00000000,
-0x00000023,0x00000000,0x00030047,0x000000b7,
-0x00000003,0x00040047,0x000000b9,0x00000022,
-0x00000000,0x00040047,0x000000b9,0x00000021,
-0x00000004,0x00040047,0x000000c9,0x0000000b,
-0x00000019,0x00020013,0x00000002,0x00030021,
-0x00000003,0x00000002,0x00040015,0x00000006,
-0x00000020,0x00000000,0x00030016,0x00000008,
-0x00000020,0x00040017,0x00000011,0x00000008,
-0x00000002,0x0004002b,0x00000006,0x0000001c,
-0xac564b05,0x00040015,0x00000021,0x00000020,
-0x00000001,0x0004002b,0x00000021,0x00000022,
-0x0000000e,0x0004002b,0x00000021,0x00000029,
-0x00000008,0x0004002b,0x00000008,0x0000002c,
-0x33800000,0x0004002b,0x00000006,0x00000034,
-0x00000000,0x0004002b,0x00000006,0x0000003b,
-0x00000003,0x00020014,0x0000003c,0x0004002b,
-0x00000006,0x0000003f,0x9e3779b1,0x0004002b,
-0x00000006,0x00000041,0x64e29cc5,0x0004002b,
-0x00000021,0x00000045,0x00000017,0x0004002b,
-0x00000021,0x00000049,0x00000001,0x0004002b,
-0x00000006,0x00000055,0x241244df,0x0004002b,
-0x00000006,0x00000057,0xc283ccd7,0x0004002b,
-0x00000021,0x0000005b,0x00000015,0x00040017,
-0x00000073,0x00000006,0x00000003,0x00040020,
-0x00000074,0x00000001,0x00000073,0x0004003b,
-0x00000074,0x00000075,0x00000001,0x00040020,
-0x00000076,0x00000001,0x00000006,0x00040017,
-0x0000007a,0x00000021,0x00000002,0x0008001e,
-0x0000007b,0x0000007a,0x00000006,0x00000006,
-0x00000006,0x00000006,0x00000006,0x00040020,
-0x0000007c,0x00000002,0x0000007b,0x0004003b,
-0x0000007c,0x0000007d,0x00000002,0x00040020,
-0x0000007e,0x00000002,0x00000006,0x0004002b,
-0x00000021,0x0000008f,0x00000000,0x00040020,
-0x00000090,0x00000002,0x00000021,0x0004002b,
-0x00000006,0x00000094,0x00000001,0x0003001d,
-0x0000009a,0x00000011,0x0003001e,0x0000009b,
-0x0000009a,0x00040020,0x0000009c,0x00000002,
-0x0000009b,0x0004003b,0x0000009c,0x0000009d,
-0x00000002,0x00040020,0x000000a0,0x00000002,
-0x00000011,0x0003001d,0x000000a2,0x00000008,
-0x0003001e,0x000000a3,0x000000a2,0x00040020,
-0x000000a4,0x00000002,0x000000a3,0x0004003b,
-0x000000a4,0x000000a5,0x00000002,0x00040020,
-0x000000ad,0x00000002,0x00000008,0x0003001d,
-0x000000b6,0x00000006,0x0003001e,0x000000b7,
-0x000000b6,0x00040020,0x000000b8,0x00000002,
-0x000000b7,0x0004003b,0x000000b8,0x000000b9,
-0x00000002,0x0004002b,0x00000021,0x000000be,
-0x00000004,0x0004002b,0x00000006,0x000000c8,
-0x00000080,0x0006002c,0x00000073,0x000000c9,
-0x000000c8,0x00000094,0x00000094,0x0004002b,
-0x00000008,0x0000014c,0x34c90fdb,0x00050036,
-0x00000002,0x00000004,0x00000000,0x00000003,
-0x000200f8,0x00000005,0x000300f7,0x000000cd,
-0x00000000,0x000300fb,0x00000034,0x000000ce,
-0x000200f8,0x000000ce,0x00050041,0x00000076,
-0x00000077,0x00000075,0x00000034,0x0004003d,
-0x00000006,0x00000078,0x00000077,0x00050041,
-0x0000007e,0x0000007f,0x0000007d,0x00000049,
-0x0004003d,0x00000006,0x00000080,0x0000007f,
-0x000500ae,0x0000003c,0x00000081,0x00000078,
-0x00000080,0x000300f7,0x00000083,0x00000000,
-0x000400fa,0x00000081,0x00000082,0x00000083,
-0x000200f8,0x00000082,0x000200f9,0x000000cd,
-0x000200f8,0x00000083,0x000200f9,0x000000d9,
-0x000200f8,0x000000d9,0x000700f5,0x00000006,
-0x00000148,0x00000078,0x00000083,0x000000e4,
-0x000000dd,0x000700f5,0x00000006,0x00000145,
-0x00000034,0x00000083,0x000000e7,0x000000dd,
-0x000500b0,0x0000003c,0x000000dc,0x00000145,
-0x0000003b,0x000400f6,0x000000e8,0x000000dd,
-0x00000000,0x000400fa,0x000000dc,0x000000dd,
-0x000000e8,0x000200f8,0x000000dd,0x00050084,
-0x00000006,0x000000df,0x00000148,0x0000003f,
-0x00050080,0x00000006,0x000000e0,0x000000df,
-0x00000041,0x000500c2,0x00000006,0x000000e3,
-0x000000e0,0x00000045,0x000500c6,0x00000006,
-0x000000e4,0x000000e0,0x000000e3,0x00050080,
-0x00000006,0x000000e7,0x00000145,0x00000049,
-0x000200f9,0x000000d9,0x000200f8,0x000000e8,
-0x000200f9,0x000000ea,0x000200f8,0x000000ea,
-0x000700f5,0x00000006,0x00000149,0x00000078,
-0x000000e8,0x000000f1,0x000000ee,0x000700f5,
-0x00000006,0x00000147,0x00000148,0x000000e8,
-0x000000f5,0x000000ee,0x000700f5,0x00000006,
-0x00000146,0x00000034,0x000000e8,0x000000f8,
-0x000000ee,0x000500b0,0x0000003c,0x000000ed,
-0x00000146,0x0000003b,0x000400f6,0x000000f9,
-0x000000ee,0x00000000,0x000400fa,0x000000ed,
-0x000000ee,0x000000f9,0x000200f8,0x000000ee,
-0x00050084,0x00000006,0x000000f0,0x00000149,
-0x00000055,0x00050080,0x00000006,0x000000f1,
-0x000000f0,0x00000057,0x000500c2,0x00000006,
-0x000000f4,0x000000f1,0x0000005b,0x000500c6,
-0x00000006,0x000000f5,0x000000f1,0x000000f4,
-0x00050080,0x00000006,0x000000f8,0x00000146,
-0x00000049,0x000200f9,0x000000ea,0x000200f8,
-0x000000f9,0x00050084,0x00000006,0x00000111,
-0x00000147,0x00000149,0x00050080,0x00000006,
-0x00000112,0x00000111,0x0000001c,0x000500c2,
-0x00000006,0x00000115,0x00000112,0x00000022,
-0x000500c6,0x00000006,0x00000116,0x00000112,
-0x00000115,0x000500c2,0x00000006,0x00000119,
-0x00000116,0x00000029,0x00040070,0x00000008,
-0x0000011a,0x00000119,0x00050085,0x00000008,
-0x0000011b,0x0000011a,0x0000002c,0x00050084,
-0x00000006,0x00000124,0x00000116,0x00000149,
-0x00050080,0x00000006,0x00000125,0x00000124,
-0x0000001c,0x000500c2,0x00000006,0x00000128,
-0x00000125,0x00000022,0x000500c6,0x00000006,
-0x00000129,0x00000125,0x00000128,0x000500c2,
-0x00000006,0x0000012c,0x00000129,0x00000029,
-0x00040070,0x00000008,0x0000012d,0x0000012c,
-0x00050085,0x00000008,0x0000012e,0x0000012d,
-0x0000002c,0x00050050,0x00000011,0x00000109,
-0x0000011b,0x0000012e,0x00060041,0x00000090,
-0x00000091,0x0000007d,0x0000008f,0x00000034,
-0x0004003d,0x00000021,0x00000092,0x00000091,
-0x0004006f,0x00000008,0x00000093,0x00000092,
-0x00060041,0x00000090,0x00000095,0x0000007d,
-0x0000008f,0x00000094,0x0004003d,0x00000021,
-0x00000096,0x00000095,0x0004006f,0x00000008,
-0x00000097,0x00000096,0x00050050,0x00000011,
-0x00000098,0x00000093,0x00000097,0x00050085,
-0x00000011,0x00000099,0x00000109,0x00000098,
-0x00060041,0x000000a0,0x000000a1,0x0000009d,
-0x0000008f,0x00000078,0x0003003e,0x000000a1,
-0x00000099,0x00050084,0x00000006,0x00000137,
-0x00000129,0x00000149,0x00050080,0x00000006,
-0x00000138,0x00000137,0x0000001c,0x000500c2,
-0x00000006,0x0000013b,0x00000138,0x00000022,
-0x000500c6,0x00000006,0x0000013c,0x00000138,
-0x0000013b,0x000500c2,0x00000006,0x0000013f,
-0x0000013c,0x00000029,0x00040070,0x00000008,
-0x00000140,0x0000013f,0x00050085,0x00000008,
-0x000000ac,0x00000140,0x0000014c,0x00060041,
-0x000000ad,0x000000ae,0x000000a5,0x0000008f,
-0x00000078,0x0003003e,0x000000ae,0x000000ac,
-0x0004006e,0x0000007a,0x000000b5,0x00000099,
-0x00050051,0x00000021,0x000000bc,0x000000b5,
-0x00000001,0x0004007c,0x00000006,0x000000bd,
-0x000000bc,0x00050041,0x0000007e,0x000000bf,
-0x0000007d,0x000000be,0x0004003d,0x00000006,
-0x000000c0,0x000000bf,0x00050084,0x00000006,
-0x000000c1,0x000000bd,0x000000c0,0x00050051,
-0x00000021,0x000000c3,0x000000b5,0x00000000,
-0x0004007c,0x00000006,0x000000c4,0x000000c3,
-0x00050080,0x00000006,0x000000c5,0x000000c1,
-0x000000c4,0x00060041,0x0000007e,0x000000c6,
-0x000000b9,0x0000008f,0x000000c5,0x000700ea,
-0x00000006,0x000000c7,0x000000c6,0x00000094,
-0x00000034,0x00000094,0x000200f9,0x000000cd,
-0x000200f8,0x000000cd,0x000100fd,0x00010038}
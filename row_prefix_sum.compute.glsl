@@ -0,0 +1,86 @@
+#version 450
+#include "shared_constants.h"
+#ifdef FUSED_FADE
+#define SCAN_SLICES FUSED_FADE_SLICES
+layout(local_size_x = 128, local_size_y = FUSED_FADE_SLICES) in;
+#else
+layout(local_size_x = 128) in;
+#endif
+
+#include "bindings.glsl.h"
+#include "scan.glsl.h"
+#ifdef FUSED_FADE
+#include "occupancy.glsl.h"
+#include "fade.glsl.h"
+
+shared uint segment_totals[FUSED_FADE_SLICES];
+#endif
+
+// One workgroup per density buffer row. The row is scanned 128 cells at a time
+// and the running total is carried into the next chunk.
+// The FUSED_FADE build also does the work of fade.compute.glsl. It first shades the image rows this density row
+// covers, then scans. Every cell of the read half is read here exactly once, so it is zeroed right away for next
+// frame, when it becomes the write half. At a downscale above 1 a density row covers several image rows, so this
+// build runs FUSED_FADE_SLICES slices of 128 lanes: all of them share the shading, and each slice scans its own
+// segment of the row before the totals of the segments to its left are added on.
+void main() {
+	uint row = gl_WorkGroupID.x;
+	uint lane = gl_LocalInvocationID.x;
+	uint slice = gl_LocalInvocationID.y;
+
+#ifdef FUSED_FADE
+	int first_y = int(row) * DensityBufferDownscale;
+	int texel_count = (min(first_y + DensityBufferDownscale, ImageSize.y) - first_y) * ImageSize.x;
+	for (int i = int(gl_LocalInvocationIndex); i < texel_count; i += SCAN_GROUP_SIZE * FUSED_FADE_SLICES) {
+		shade_texel(flip_y(ivec2(i % ImageSize.x, first_y + i / ImageSize.x)));
+	}
+	// the cells are zeroed below by other lanes than the ones that shaded from them
+	memoryBarrierBuffer();
+	barrier();
+#endif
+
+	uint read_offset = density_read_offset();
+	uint row_start = row * DensityBufferWidth;
+	uint carry = 0;
+
+	// the same length for every slice, which all have to reach the barriers of the scan
+	const uint slice_cells = SCAN_GROUP_SIZE * SCAN_SLICES;
+	uint segment_length = (DensityBufferWidth + slice_cells - 1) / slice_cells * SCAN_GROUP_SIZE;
+	uint segment_start = slice * segment_length;
+
+	for (uint chunk = 0; chunk < segment_length; chunk += SCAN_GROUP_SIZE) {
+		uint x = segment_start + chunk + lane;
+		uint value = (x < DensityBufferWidth) ? DensityField[read_offset + density_index(ivec2(x, row))] : 0;
+#ifdef FUSED_FADE
+		// the single half of IncrementalDensity is never cleared
+		if (x < DensityBufferWidth && IncrementalDensity == 0) {
+			DensityField[read_offset + density_index(ivec2(x, row))] = 0;
+		}
+#endif
+
+		uint chunk_total;
+		uint prefix = workgroup_inclusive_scan(value, chunk_total);
+
+		if (x < DensityBufferWidth) {
+			RowPrefixSums[row_start + x] = carry + prefix;
+		}
+		carry += chunk_total;
+	}
+
+#ifdef FUSED_FADE
+	segment_totals[slice] = carry;
+	barrier();
+	uint segment_offset = 0;
+	for (uint i = 0; i < slice; ++i) {
+		segment_offset += segment_totals[i];
+	}
+	if (segment_offset != 0) {
+		for (uint chunk = 0; chunk < segment_length; chunk += SCAN_GROUP_SIZE) {
+			uint x = segment_start + chunk + lane;
+			if (x < DensityBufferWidth) {
+				RowPrefixSums[row_start + x] += segment_offset;
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,30 @@
+// Workgroup-wide prefix sums for kernels running with local_size_x = SCAN_GROUP_SIZE.
+// These contain barriers, so every invocation of the workgroup has to call them.
+// A kernel can define SCAN_SLICES and run that many rows of SCAN_GROUP_SIZE lanes (local_size_y), which each scan
+// their own values.
+#define SCAN_GROUP_SIZE 128
+#ifndef SCAN_SLICES
+#define SCAN_SLICES 1
+#endif
+
+shared uint scan_partial_sums[SCAN_SLICES][SCAN_GROUP_SIZE];
+
+// returns the inclusive prefix sum of value across the workgroup and writes the sum of all values to total
+uint workgroup_inclusive_scan(uint value, out uint total) {
+	uint lane = gl_LocalInvocationID.x;
+	uint slice = gl_LocalInvocationID.y;
+	scan_partial_sums[slice][lane] = value;
+	barrier();
+
+	for (uint stride = 1; stride < SCAN_GROUP_SIZE; stride <<= 1) {
+		uint addend = (lane >= stride) ? scan_partial_sums[slice][lane - stride] : 0;
+		barrier();
+		scan_partial_sums[slice][lane] += addend;
+		barrier();
+	}
+
+	uint result = scan_partial_sums[slice][lane];
+	total = scan_partial_sums[slice][SCAN_GROUP_SIZE - 1];
+	barrier();
+	return result;
+}
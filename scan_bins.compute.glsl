@@ -0,0 +1,32 @@
+#version 450
+layout(local_size_x = 128) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "scan.glsl.h"
+#include "binning.glsl.h"
+
+// Single workgroup. Turns the per bin counts into an exclusive prefix sum in place,
+// so each bin's particles start at Bins[bin] and end at Bins[bin + 1].
+void main() {
+	uint lane = gl_LocalInvocationID.x;
+	uint total_bins = bin_count();
+	uint carry = 0;
+
+	for (uint chunk = 0; chunk < total_bins; chunk += SCAN_GROUP_SIZE) {
+		uint bin = chunk + lane;
+		uint value = (bin < total_bins) ? Bins[bin] : 0;
+
+		uint chunk_total;
+		uint prefix = workgroup_inclusive_scan(value, chunk_total);
+
+		if (bin < total_bins) {
+			Bins[bin] = carry + prefix - value;
+		}
+		carry += chunk_total;
+	}
+
+	if (lane == 0) {
+		Bins[total_bins] = carry;
+	}
+}
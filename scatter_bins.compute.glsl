@@ -0,0 +1,24 @@
+#version 450
+layout(local_size_x = 128) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "binning.glsl.h"
+
+// Writes each particle index into its bin's range of BinnedParticles
+void main() {
+	uint idx = gl_GlobalInvocationID.x;
+
+	if (idx >= ParticleCount) {
+		return;
+	}
+
+	vec2 position = load_position(idx);
+	uint destination = Bins[particle_bin(position)] + ParticleBinSlots[idx];
+	BinnedParticles[destination] = idx;
+
+	// the cell list engine reads neighbor positions from this copy, as the particle buffer is updated while it runs
+	if (BinKey == BIN_KEY_CELL) {
+		BinnedPositions[destination] = position;
+	}
+}
@@ -0,0 +1,64 @@
+// Half-disc neighbor counting over the density field, shared by the density based simulate kernels.
+// The including shader defines int row_range_sum(int row, int first, int last, bool wrap), which returns
+// the number of particles in the cells first..last (inclusive) of a row of the density field it reads.
+
+// A cell (x, y) is on the left when dot((x, y), (-direction.y, direction.x)) > 0, i.e. x * direction.y < y * direction.x.
+// Every row of the disc therefore splits into one left and one right run.
+// With FIXED_POINT_MOTION the direction is integer valued and the split point is found by exact integer division,
+// so the counts do not depend on the device's float division.
+// Called with a literal wrap, so the interior and border cases each inline into their own loop.
+#if FIXED_POINT_MOTION
+// floor(a / b) for b > 0
+int floor_div(int a, int b) {
+	return (a >= 0) ? a / b : -((b - 1 - a) / b);
+}
+#endif
+
+void count_neighbors(ivec2 center, vec2 direction, bool wrap, inout int left, inout int right) {
+	for (int y = -DiscRowCount; y <= DiscRowCount; ++y) {
+		int half_width = DiscHalfWidths[abs(y)];
+		int row = center.y + y;
+		if (wrap) {
+			row = (row + int(DensityBufferHeight)) % int(DensityBufferHeight);
+		}
+		int first = center.x - half_width;
+		int last = center.x + half_width;
+
+		if (direction.y == 0.0) {
+			int row_sum = row_range_sum(row, first, last, wrap);
+			if (float(y) * direction.x > 0.0) {
+				left += row_sum;
+			} else {
+				right += row_sum;
+			}
+			continue;
+		}
+
+#if FIXED_POINT_MOTION
+		ivec2 fixed_direction = ivec2(direction);
+		int split_numerator = y * fixed_direction.x;
+#else
+		float split = clamp(float(y) * direction.x / direction.y, float(-half_width - 1), float(half_width + 1));
+#endif
+		if (direction.y > 0.0) {
+#if FIXED_POINT_MOTION
+			int right_start = -floor_div(-split_numerator, fixed_direction.y);
+#else
+			int right_start = int(ceil(split));
+#endif
+			left += row_range_sum(row, first, center.x + min(half_width, right_start - 1), wrap);
+			right += row_range_sum(row, center.x + max(-half_width, right_start), last, wrap);
+		} else {
+#if FIXED_POINT_MOTION
+			int right_end = floor_div(-split_numerator, -fixed_direction.y);
+#else
+			int right_end = int(floor(split));
+#endif
+			left += row_range_sum(row, center.x + max(-half_width, right_end + 1), last, wrap);
+			right += row_range_sum(row, first, center.x + min(half_width, right_end), wrap);
+		}
+	}
+
+	// the particle's own cell lies on the dividing line, which counts as right
+	right -= 1;
+}
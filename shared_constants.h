@@ -1,2 +1,95 @@
 #define MAX_PARTICLE_COUNT (1024 * 128)
 #define DENSITY_BUFFER_DOWNSCALE 1
+
+// memory layout of each half of the density field, see density_index in bindings.glsl.h
+#define DENSITY_LAYOUT_LINEAR 0 // row major
+#define DENSITY_LAYOUT_BLOCKED 1 // row major DENSITY_BLOCK_SIZE x DENSITY_BLOCK_SIZE blocks, row major inside each block
+#define DENSITY_LAYOUT_MORTON 2 // Z-order curve, both sides padded to a power of two
+#define DENSITY_LAYOUT DENSITY_LAYOUT_LINEAR
+#define DENSITY_BLOCK_SIZE 8
+
+// edge length (in density buffer cells) of the square tiles the tiled simulate kernel works on
+#define SIMULATE_TILE_SIZE 16
+
+// rows of 128 invocations in each workgroup of the FUSED_FADE build of row_prefix_sum.compute.glsl
+#define FUSED_FADE_SLICES 4
+
+// keys the binning passes bucket particles by
+#define BIN_KEY_TILE 0 // row major SIMULATE_TILE_SIZE tiles, used by the tiled simulate kernel
+#define BIN_KEY_MORTON 1 // Z-order curve over the density buffer, used to reorder the particle buffers
+#define BIN_KEY_CELL 2 // cells of at least CellListCellSize pixels, used by the cell list engine
+#define MORTON_BIN_BITS 16
+#define MORTON_BIN_COUNT (1 << MORTON_BIN_BITS)
+
+// lower bound on the cell list's cell size in pixels, which bounds the number of bins at small radii
+#define CELL_LIST_MIN_CELL_SIZE 4
+
+// FFT engine: the density field is convolved with FFT_ORIENTATION_BINS left half-disc kernels and the full disc.
+// Two real kernels share each complex layer of the FftLayers buffer: layer 0 holds the density spectrum,
+// followed by FFT_KERNEL_PAIRS kernel spectra and FFT_KERNEL_PAIRS responses.
+#define FFT_ORIENTATION_BINS 8
+#define FFT_KERNEL_PAIRS ((FFT_ORIENTATION_BINS + 2) / 2)
+#define FFT_FIRST_KERNEL_LAYER 1
+#define FFT_FIRST_RESPONSE_LAYER (FFT_FIRST_KERNEL_LAYER + FFT_KERNEL_PAIRS)
+#define FFT_LAYER_COUNT (FFT_FIRST_RESPONSE_LAYER + FFT_KERNEL_PAIRS)
+// largest transform length, bounded by the shared memory of one workgroup (FFT_MAX_SIZE complex values)
+#define FFT_MAX_SIZE 2048
+// the transforms wrap around, so the density field is padded by a copy of its opposite edges this wide
+#define FFT_HALO MAX_DISC_ROWS
+
+// particles added per spawn request, and the radius in pixels of the region they are spawned into or removed from
+#define SPAWN_BATCH_SIZE 4096
+#define EDIT_REGION_RADIUS 48
+
+// each frame the red trail channel is multiplied by TRAIL_DECAY, and pixels dimmer than TRAIL_CUTOFF go black
+#define TRAIL_DECAY 0.9525
+#define TRAIL_CUTOFF 0.125
+
+// Bitmap engine: cells holding more than one particle keep their extra particles in an open addressing table.
+// With as many entries as particles it stays at most half full, since every overflowing cell holds two or more.
+#define OCCUPANCY_OVERFLOW_BITS 17
+#define OCCUPANCY_OVERFLOW_CAPACITY (1 << OCCUPANCY_OVERFLOW_BITS)
+
+// Integer motion law. Headings are FIXED_ANGLE_BITS binary angles, with 1 << FIXED_ANGLE_BITS units per turn.
+// Positions are rounded to FIXED_POSITION_BITS fractional bits. Both stay exactly representable in the float
+// Angles and Positions buffers (for images up to 32768 pixels wide), so the other passes read them unchanged.
+// Directions come from a quarter wave sine table with entries scaled by 1 << SINE_TABLE_BITS, built on the host.
+// The row prefix sum, tiled, cell list and occupancy bitmap engines then sense in integers and are bit-exact across
+// devices. The FFT engine convolves in float and is not: its counts are rounded from device dependent transforms.
+#define FIXED_POINT_MOTION 0
+#define FIXED_ANGLE_BITS 16
+#define FIXED_POSITION_BITS 8
+#define SINE_TABLE_BITS (FIXED_ANGLE_BITS - 2)
+
+// Store each particle in one 8 byte element of the position buffer instead of a vec2 plus a float angle:
+// x and y as 16 bit fractions of the image size and the heading as a 16 bit fraction of a turn.
+// Positions are then only kept to 1/65536 of the image, so this cannot be combined with FIXED_POINT_MOTION.
+#define PACKED_PARTICLES 0
+#if PACKED_PARTICLES && FIXED_POINT_MOTION
+#error PACKED_PARTICLES cannot hold the fixed point positions of FIXED_POINT_MOTION
+#endif
+
+// keep a ParticleIds buffer that follows the particles through reordering, so individuals can be tracked
+#define TRACK_PARTICLE_IDS 0
+
+// largest half-height (in density buffer cells) of the sensing disc a pipeline variant may use
+#define MAX_DISC_ROWS 32
+
+// specialization constant ids shared by the shaders and the pipeline variant builder
+#define SPEC_ID_SEARCH_RADIUS_SQUARED 0
+#define SPEC_ID_ALPHA 1
+#define SPEC_ID_BETA 2
+#define SPEC_ID_DENSITY_BUFFER_DOWNSCALE 3
+#define SPEC_ID_DISC_ROW_COUNT 4
+#define SPEC_ID_DISC_HALF_WIDTHS 5 // MAX_DISC_ROWS + 1 consecutive ids
+#define SPEC_ID_BIN_KEY (SPEC_ID_DISC_HALF_WIDTHS + MAX_DISC_ROWS + 1)
+#define SPEC_ID_CELL_LIST_CELL_SIZE (SPEC_ID_BIN_KEY + 1)
+#define SPEC_ID_FFT_AXIS (SPEC_ID_CELL_LIST_CELL_SIZE + 1)
+#define SPEC_ID_FFT_INVERSE (SPEC_ID_FFT_AXIS + 1)
+#define SPEC_ID_FFT_FIRST_LAYER (SPEC_ID_FFT_INVERSE + 1)
+#define SPEC_ID_FIXED_ALPHA (SPEC_ID_FFT_FIRST_LAYER + 1)
+#define SPEC_ID_FIXED_BETA (SPEC_ID_FIXED_ALPHA + 1)
+#define SPEC_ID_PARTICLE_GROUP_SIZE (SPEC_ID_FIXED_BETA + 1)
+#define SPEC_ID_IMAGE_GROUP_WIDTH (SPEC_ID_PARTICLE_GROUP_SIZE + 1)
+#define SPEC_ID_IMAGE_GROUP_HEIGHT (SPEC_ID_IMAGE_GROUP_WIDTH + 1)
+#define SPEC_ID_COUNT (SPEC_ID_IMAGE_GROUP_HEIGHT + 1)
@@ -1,13 +1,42 @@
 #version 450
-layout(local_size_x = 128) in;
-
 #include "shared_constants.h"
+// the size is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_PARTICLE_GROUP_SIZE) in;
 #include "bindings.glsl.h"
 
-float deg2rad(float degrees) {
-    return degrees * 0.017453292519943295; // π / 180
+// sum of the cells first..last (inclusive) of a density buffer row; with wrap set, columns may lie outside the row
+int row_range_sum(int row, int first, int last, bool wrap) {
+	if (last < first) {
+		return 0;
+	}
+
+	uint row_start = uint(row) * DensityBufferWidth;
+
+	if (!wrap) {
+		uint sum = RowPrefixSums[row_start + last];
+		if (first > 0) {
+			sum -= RowPrefixSums[row_start + first - 1];
+		}
+		return int(sum);
+	}
+
+	int width = int(DensityBufferWidth);
+	int start = ((first % width) + width) % width;
+	int end = start + (last - first);
+
+	uint sum = RowPrefixSums[row_start + min(end, width - 1)];
+	if (start > 0) {
+		sum -= RowPrefixSums[row_start + start - 1];
+	}
+	if (end >= width) {
+		sum += RowPrefixSums[row_start + end - width];
+	}
+	return int(sum);
 }
 
+#include "sensing.glsl.h"
+#include "motion.glsl.h"
+
 void main() {
 
 	uint idx = gl_GlobalInvocationID.x;
@@ -16,58 +45,52 @@ void main() {
 		return;
 	}
 
-	uint write_offset = bool(FrameNumber & 0x1) ? DensityBufferLength : 0;
-	uint read_offset =  bool(FrameNumber & 0x1) ? 0 : DensityBufferLength;
+	vec2 position = load_position(idx);
+	float angle = load_angle(idx);
 
-	vec2 position = Positions[idx];
-	float angle = Angles[idx];
+	vec2 direction = heading_direction(angle);
 
-	vec2 direction = vec2(cos(angle), sin(angle));
+	// Staggered refresh: each frame only every NeighborRefreshPeriod-th particle (round robin by index)
+	// recounts its neighbors, the others steer with the counts cached at their last refresh
+	bool refresh = NeighborRefreshAll != 0 || idx % NeighborRefreshPeriod == frame_number() % NeighborRefreshPeriod;
 
 	int left = 0;
 	int right = 0;
-	int search_radius = 128;
-	ivec2 density_buffer_position = ivec2(position / DENSITY_BUFFER_DOWNSCALE);
-
-	for (int y = -search_radius; y <= search_radius; ++y) {
-		for (int x = -search_radius; x <= search_radius; ++x) {
-			if (y*y + x*x > search_radius) continue;
-
-			int is_self = (y == 0 && x == 0) ? 1 : 0;
-
-			ivec2 DensityBufferDimensions = ivec2(DensityBufferWidth, DensityBufferHeight);
-			ivec2 tile = density_buffer_position + ivec2(x, y);
-			tile = (tile + DensityBufferDimensions) % DensityBufferDimensions;
-			uint index = read_offset + (tile.y * DensityBufferWidth + tile.x);
-			uint particle_count = DensityField[index];
-			particle_count -= is_self;
-
-			// counter-clockwise rotation by 90 degrees
-			vec2 rotated_direction = vec2(-direction.y, direction.x);
-			if (dot(vec2(x, y), rotated_direction) > 0.0) {
-				left += int(particle_count);
-			} else {
-				right += int(particle_count);
-			}
+	if (refresh || MeasureRefreshError != 0) {
+		ivec2 density_buffer_position = ivec2(position / DensityBufferDownscale);
+
+		// DiscHalfWidths[0] is the widest row, so particles at least that far from every edge never wrap
+		int margin_x = DiscHalfWidths[0];
+		int margin_y = DiscRowCount;
+		bool interior =
+			density_buffer_position.x >= margin_x && density_buffer_position.x < int(DensityBufferWidth) - margin_x &&
+			density_buffer_position.y >= margin_y && density_buffer_position.y < int(DensityBufferHeight) - margin_y;
+
+		if (interior) {
+			count_neighbors(density_buffer_position, direction, false, left, right);
+		} else {
+			count_neighbors(density_buffer_position, direction, true, left, right);
 		}
 	}
 
-	float alpha = deg2rad(5.0);
-	float beta = deg2rad(12.0);
-	float count = float(left + right);
-	angle -= alpha + beta * count * sign(right - left);
-	direction = vec2(cos(angle), sin(angle));
-
-	position = mod(position + direction, vec2(ImageSize.x, ImageSize.y));
-	Positions[idx] = position;
-	Angles[idx] = angle;
-
-	vec4 color = vec4(0.0, 1.0, 0.0, 1.0);
-	imageStore(OutputImage, flip_y(ivec2(position)), color);
-
-	{
-		ivec2 rounded_pos = ivec2(position / DENSITY_BUFFER_DOWNSCALE);
-		uint index = rounded_pos.y * DensityBufferWidth + rounded_pos.x;
-		atomicAdd(DensityField[write_offset + index], 1u);
+	if (NeighborRefreshPeriod > 1) {
+		if (refresh) {
+			NeighborCounts[idx] = ivec2(left, right);
+		} else {
+			ivec2 cached = NeighborCounts[idx];
+			if (MeasureRefreshError != 0) {
+				uint error = uint(abs(cached.x - left) + abs(cached.y - right));
+				atomicAdd(RefreshErrorCachedParticles, 1u);
+				atomicAdd(RefreshErrorCountSum, error);
+				atomicMax(RefreshErrorMaxCount, error);
+				if (sign(cached.y - cached.x) != sign(right - left)) {
+					atomicAdd(RefreshErrorWrongTurns, 1u);
+				}
+			}
+			left = cached.x;
+			right = cached.y;
+		}
 	}
+
+	step_particle(idx, position, angle, left, right);
 }
@@ -1,271 +0,0 @@
-{0x07230203,0x00010000,0x000d000b,0x0000018d,
-0x00000000,0x00020011,0x00000001,0x0006000b,
-0x00000001,0x4c534c47,0x6474732e,0x3035342e,
-0x00000000,0x0003000e,0x00000000,0x00000001,
-0x0006000f,0x00000005,0x00000004,0x6e69616d,
-0x00000000,0x0000002f,0x00060010,0x00000004,
-0x00000011,0x00000080,0x00000001,0x00000001,
-0x00050048,0x00000014,0x00000000,0x00000023,
-0x00000000,0x00050048,0x00000014,0x00000001,
-0x00000023,0x00000008,0x00050048,0x00000014,
-0x00000002,0x00000023,0x0000000c,0x00050048,
-0x00000014,0x00000003,0x00000023,0x00000010,
-0x00050048,0x00000014,0x00000004,0x00000023,
-0x00000014,0x00050048,0x00000014,0x00000005,
-0x00000023,0x00000018,0x00030047,0x00000014,
-0x00000002,0x00040047,0x00000016,0x00000022,
-0x00000000,0x00040047,0x00000016,0x00000021,
-0x00000001,0x00040047,0x0000002f,0x0000000b,
-0x0000001c,0x00040047,0x0000005a,0x00000006,
-0x00000008,0x00050048,0x0000005b,0x00000000,
-0x00000023,0x00000000,0x00030047,0x0000005b,
-0x00000003,0x00040047,0x0000005d,0x00000022,
-0x00000000,0x00040047,0x0000005d,0x00000021,
-0x00000002,0x00040047,0x00000063,0x00000006,
-0x00000004,0x00050048,0x00000064,0x00000000,
-0x00000023,0x00000000,0x00030047,0x00000064,
-0x00000003,0x00040047,0x00000066,0x00000022,
-0x00000000,0x00040047,0x00000066,0x00000021,
-0x00000003,0x00040047,0x000000c7,0x00000006,
-0x00000004,0x00050048,0x000000c8,0x00000000,
-0x00000023,0x00000000,0x00030047,0x000000c8,
-0x00000003,0x00040047,0x000000ca,0x00000022,
-0x00000000,0x00040047,0x000000ca,0x00000021,
-0x00000004,0x00040047,0x00000127,0x00000022,
-0x00000000,0x00040047,0x00000127,0x00000021,
-0x00000000,0x00040047,0x00000144,0x0000000b,
-0x00000019,0x00020013,0x00000002,0x00030021,
-0x00000003,0x00000002,0x00040015,0x00000006,
-0x00000020,0x00000001,0x00040017,0x00000007,
-0x00000006,0x00000002,0x00030016,0x0000000d,
-0x00000020,0x00040015,0x00000013,0x00000020,
-0x00000000,0x0008001e,0x00000014,0x00000007,
-0x00000013,0x00000013,0x00000013,0x00000013,
-0x00000013,0x00040020,0x00000015,0x00000002,
-0x00000014,0x0004003b,0x00000015,0x00000016,
-0x00000002,0x0004002b,0x00000006,0x00000017,
-0x00000000,0x0004002b,0x00000013,0x00000018,
-0x00000001,0x00040020,0x00000019,0x00000002,
-0x00000006,0x0004002b,0x00000006,0x0000001c,
-0x00000001,0x00040017,0x0000002d,0x00000013,
-0x00000003,0x00040020,0x0000002e,0x00000001,
-0x0000002d,0x0004003b,0x0000002e,0x0000002f,
-0x00000001,0x0004002b,0x00000013,0x00000030,
-0x00000000,0x00040020,0x00000031,0x00000001,
-0x00000013,0x00040020,0x00000035,0x00000002,
-0x00000013,0x00020014,0x00000038,0x0004002b,
-0x00000006,0x0000003e,0x00000002,0x0004002b,
-0x00000006,0x00000046,0x00000003,0x00040017,
-0x00000057,0x0000000d,0x00000002,0x0003001d,
-0x0000005a,0x00000057,0x0003001e,0x0000005b,
-0x0000005a,0x00040020,0x0000005c,0x00000002,
-0x0000005b,0x0004003b,0x0000005c,0x0000005d,
-0x00000002,0x00040020,0x0000005f,0x00000002,
-0x00000057,0x0003001d,0x00000063,0x0000000d,
-0x0003001e,0x00000064,0x00000063,0x00040020,
-0x00000065,0x00000002,0x00000064,0x0004003b,
-0x00000065,0x00000066,0x00000002,0x00040020,
-0x00000068,0x00000002,0x0000000d,0x0004002b,
-0x00000006,0x00000074,0x00000080,0x0004002b,
-0x0000000d,0x00000077,0x3f800000,0x0004002b,
-0x00000006,0x000000a5,0x00000004,0x0004002b,
-0x00000006,0x000000a9,0x00000005,0x0003001d,
-0x000000c7,0x00000013,0x0003001e,0x000000c8,
-0x000000c7,0x00040020,0x000000c9,0x00000002,
-0x000000c8,0x0004003b,0x000000c9,0x000000ca,
-0x00000002,0x0004002b,0x0000000d,0x000000e0,
-0x00000000,0x00040017,0x00000121,0x0000000d,
-0x00000004,0x0007002c,0x00000121,0x00000124,
-0x000000e0,0x00000077,0x000000e0,0x00000077,
-0x00090019,0x00000125,0x0000000d,0x00000001,
-0x00000000,0x00000000,0x00000000,0x00000002,
-0x00000004,0x00040020,0x00000126,0x00000000,
-0x00000125,0x0004003b,0x00000126,0x00000127,
-0x00000000,0x0004002b,0x00000013,0x00000143,
-0x00000080,0x0006002c,0x0000002d,0x00000144,
-0x00000143,0x00000018,0x00000018,0x0004002b,
-0x00000006,0x00000186,0xffffff80,0x0004002b,
-0x0000000d,0x0000018b,0x3db2b8c2,0x0004002b,
-0x0000000d,0x0000018c,0x3e567750,0x00050036,
-0x00000002,0x00000004,0x00000000,0x00000003,
-0x000200f8,0x00000005,0x000300f7,0x00000147,
-0x00000000,0x000300fb,0x00000030,0x00000148,
-0x000200f8,0x00000148,0x00050041,0x00000031,
-0x00000032,0x0000002f,0x00000030,0x0004003d,
-0x00000013,0x00000033,0x00000032,0x00050041,
-0x00000035,0x00000036,0x00000016,0x0000001c,
-0x0004003d,0x00000013,0x00000037,0x00000036,
-0x000500ae,0x00000038,0x00000039,0x00000033,
-0x00000037,0x000300f7,0x0000003b,0x00000000,
-0x000400fa,0x00000039,0x0000003a,0x0000003b,
-0x000200f8,0x0000003a,0x000200f9,0x00000147,
-0x000200f8,0x0000003b,0x00050041,0x00000035,
-0x0000003f,0x00000016,0x0000003e,0x0004003d,
-0x00000013,0x00000040,0x0000003f,0x000500c7,
-0x00000013,0x00000041,0x00000040,0x00000018,
-0x000500ab,0x00000038,0x00000042,0x00000041,
-0x00000030,0x000300f7,0x00000045,0x00000000,
-0x000400fa,0x00000042,0x00000044,0x00000049,
-0x000200f8,0x00000044,0x00050041,0x00000035,
-0x00000047,0x00000016,0x00000046,0x0004003d,
-0x00000013,0x00000048,0x00000047,0x000200f9,
-0x00000045,0x000200f8,0x00000049,0x000200f9,
-0x00000045,0x000200f8,0x00000045,0x000700f5,
-0x00000013,0x00000168,0x00000048,0x00000044,
-0x00000030,0x00000049,0x000300f7,0x00000052,
-0x00000000,0x000400fa,0x00000042,0x00000051,
-0x00000053,0x000200f8,0x00000051,0x000200f9,
-0x00000052,0x000200f8,0x00000053,0x00050041,
-0x00000035,0x00000054,0x00000016,0x00000046,
-0x0004003d,0x00000013,0x00000055,0x00000054,
-0x000200f9,0x00000052,0x000200f8,0x00000052,
-0x000700f5,0x00000013,0x00000169,0x00000030,
-0x00000051,0x00000055,0x00000053,0x00060041,
-0x0000005f,0x00000060,0x0000005d,0x00000017,
-0x00000033,0x0004003d,0x00000057,0x00000061,
-0x00000060,0x00060041,0x00000068,0x00000069,
-0x00000066,0x00000017,0x00000033,0x0004003d,
-0x0000000d,0x0000006a,0x00000069,0x0006000c,
-0x0000000d,0x0000006d,0x00000001,0x0000000e,
-0x0000006a,0x0006000c,0x0000000d,0x0000006f,
-0x00000001,0x0000000d,0x0000006a,0x0004006e,
-0x00000007,0x0000007a,0x00000061,0x000200f9,
-0x0000007e,0x000200f8,0x0000007e,0x000700f5,
-0x00000006,0x0000016c,0x00000017,0x00000052,
-0x00000173,0x00000081,0x000700f5,0x00000006,
-0x0000016b,0x00000017,0x00000052,0x00000174,
-0x00000081,0x000700f5,0x00000006,0x0000016a,
-0x00000186,0x00000052,0x000000f0,0x00000081,
-0x000500b3,0x00000038,0x00000085,0x0000016a,
-0x00000074,0x000400f6,0x00000080,0x00000081,
-0x00000000,0x000400fa,0x00000085,0x0000007f,
-0x00000080,0x000200f8,0x0000007f,0x000200f9,
-0x00000089,0x000200f8,0x00000089,0x000700f5,
-0x00000006,0x00000174,0x0000016b,0x0000007f,
-0x00000183,0x0000008c,0x000700f5,0x00000006,
-0x00000173,0x0000016c,0x0000007f,0x00000181,
-0x0000008c,0x000700f5,0x00000006,0x0000016f,
-0x00000186,0x0000007f,0x000000ee,0x0000008c,
-0x000500b3,0x00000038,0x00000090,0x0000016f,
-0x00000074,0x000400f6,0x0000008b,0x0000008c,
-0x00000000,0x000400fa,0x00000090,0x0000008a,
-0x0000008b,0x000200f8,0x0000008a,0x00050084,
-0x00000006,0x00000093,0x0000016a,0x0000016a,
-0x00050084,0x00000006,0x00000096,0x0000016f,
-0x0000016f,0x00050080,0x00000006,0x00000097,
-0x00000093,0x00000096,0x000500ad,0x00000038,
-0x00000099,0x00000097,0x00000074,0x000300f7,
-0x0000009b,0x00000000,0x000400fa,0x00000099,
-0x0000009a,0x0000009b,0x000200f8,0x0000009a,
-0x000200f9,0x0000008c,0x000200f8,0x0000009b,
-0x000500aa,0x00000038,0x0000009f,0x0000016a,
-0x00000017,0x000500aa,0x00000038,0x000000a1,
-0x0000016f,0x00000017,0x000500a7,0x00000038,
-0x000000a2,0x0000009f,0x000000a1,0x000600a9,
-0x00000006,0x000000a3,0x000000a2,0x0000001c,
-0x00000017,0x00050041,0x00000035,0x000000a6,
-0x00000016,0x000000a5,0x0004003d,0x00000013,
-0x000000a7,0x000000a6,0x0004007c,0x00000006,
-0x000000a8,0x000000a7,0x00050041,0x00000035,
-0x000000aa,0x00000016,0x000000a9,0x0004003d,
-0x00000013,0x000000ab,0x000000aa,0x0004007c,
-0x00000006,0x000000ac,0x000000ab,0x00050050,
-0x00000007,0x000000ad,0x000000a8,0x000000ac,
-0x00050050,0x00000007,0x000000b2,0x0000016f,
-0x0000016a,0x00050080,0x00000007,0x000000b3,
-0x0000007a,0x000000b2,0x00050080,0x00000007,
-0x000000b6,0x000000b3,0x000000ad,0x0005008b,
-0x00000007,0x000000b8,0x000000b6,0x000000ad,
-0x00050051,0x00000006,0x000000bc,0x000000b8,
-0x00000001,0x0004007c,0x00000013,0x000000bd,
-0x000000bc,0x00050084,0x00000013,0x000000c0,
-0x000000bd,0x000000a7,0x00050051,0x00000006,
-0x000000c2,0x000000b8,0x00000000,0x0004007c,
-0x00000013,0x000000c3,0x000000c2,0x00050080,
-0x00000013,0x000000c4,0x000000c0,0x000000c3,
-0x00050080,0x00000013,0x000000c5,0x00000169,
-0x000000c4,0x00060041,0x00000035,0x000000cc,
-0x000000ca,0x00000017,0x000000c5,0x0004003d,
-0x00000013,0x000000cd,0x000000cc,0x0004007c,
-0x00000013,0x000000cf,0x000000a3,0x00050082,
-0x00000013,0x000000d1,0x000000cd,0x000000cf,
-0x0004007f,0x0000000d,0x000000d5,0x0000006f,
-0x00050050,0x00000057,0x000000d8,0x000000d5,
-0x0000006d,0x0004006f,0x0000000d,0x000000da,
-0x0000016f,0x0004006f,0x0000000d,0x000000dc,
-0x0000016a,0x00050050,0x00000057,0x000000dd,
-0x000000da,0x000000dc,0x00050094,0x0000000d,
-0x000000df,0x000000dd,0x000000d8,0x000500ba,
-0x00000038,0x000000e1,0x000000df,0x000000e0,
-0x000300f7,0x000000e3,0x00000000,0x000400fa,
-0x000000e1,0x000000e2,0x000000e8,0x000200f8,
-0x000000e2,0x0004007c,0x00000006,0x000000e5,
-0x000000d1,0x00050080,0x00000006,0x000000e7,
-0x00000174,0x000000e5,0x000200f9,0x000000e3,
-0x000200f8,0x000000e8,0x0004007c,0x00000006,
-0x000000ea,0x000000d1,0x00050080,0x00000006,
-0x000000ec,0x00000173,0x000000ea,0x000200f9,
-0x000000e3,0x000200f8,0x000000e3,0x000700f5,
-0x00000006,0x00000184,0x000000e7,0x000000e2,
-0x00000174,0x000000e8,0x000700f5,0x00000006,
-0x00000182,0x00000173,0x000000e2,0x000000ec,
-0x000000e8,0x000200f9,0x0000008c,0x000200f8,
-0x0000008c,0x000700f5,0x00000006,0x00000183,
-0x00000174,0x0000009a,0x00000184,0x000000e3,
-0x000700f5,0x00000006,0x00000181,0x00000173,
-0x0000009a,0x00000182,0x000000e3,0x00050080,
-0x00000006,0x000000ee,0x0000016f,0x0000001c,
-0x000200f9,0x00000089,0x000200f8,0x0000008b,
-0x000200f9,0x00000081,0x000200f8,0x00000081,
-0x00050080,0x00000006,0x000000f0,0x0000016a,
-0x0000001c,0x000200f9,0x0000007e,0x000200f8,
-0x00000080,0x00050080,0x00000006,0x000000fc,
-0x0000016b,0x0000016c,0x0004006f,0x0000000d,
-0x000000fd,0x000000fc,0x00050085,0x0000000d,
-0x00000101,0x0000018c,0x000000fd,0x00050082,
-0x00000006,0x00000104,0x0000016c,0x0000016b,
-0x0006000c,0x00000006,0x00000105,0x00000001,
-0x00000007,0x00000104,0x0004006f,0x0000000d,
-0x00000106,0x00000105,0x0008000c,0x0000000d,
-0x00000108,0x00000001,0x00000032,0x00000101,
-0x00000106,0x0000018b,0x00050083,0x0000000d,
-0x0000010a,0x0000006a,0x00000108,0x0006000c,
-0x0000000d,0x0000010c,0x00000001,0x0000000e,
-0x0000010a,0x0006000c,0x0000000d,0x0000010e,
-0x00000001,0x0000000d,0x0000010a,0x00050050,
-0x00000057,0x0000010f,0x0000010c,0x0000010e,
-0x00050081,0x00000057,0x00000112,0x00000061,
-0x0000010f,0x00060041,0x00000019,0x00000113,
-0x00000016,0x00000017,0x00000030,0x0004003d,
-0x00000006,0x00000114,0x00000113,0x0004006f,
-0x0000000d,0x00000115,0x00000114,0x00060041,
-0x00000019,0x00000116,0x00000016,0x00000017,
-0x00000018,0x0004003d,0x00000006,0x00000117,
-0x00000116,0x0004006f,0x0000000d,0x00000118,
-0x00000117,0x00050050,0x00000057,0x00000119,
-0x00000115,0x00000118,0x0005008d,0x00000057,
-0x0000011a,0x00000112,0x00000119,0x0003003e,
-0x00000060,0x0000011a,0x0003003e,0x00000069,
-0x0000010a,0x0004003d,0x00000125,0x00000128,
-0x00000127,0x0004006e,0x00000007,0x0000012a,
-0x0000011a,0x00050082,0x00000006,0x00000159,
-0x00000117,0x0000001c,0x00050051,0x00000006,
-0x0000015b,0x0000012a,0x00000001,0x00050082,
-0x00000006,0x0000015c,0x00000159,0x0000015b,
-0x00060052,0x00000007,0x00000165,0x0000015c,
-0x0000012a,0x00000001,0x00040063,0x00000128,
-0x00000165,0x00000124,0x0004007c,0x00000013,
-0x00000136,0x0000015b,0x00050041,0x00000035,
-0x00000137,0x00000016,0x000000a5,0x0004003d,
-0x00000013,0x00000138,0x00000137,0x00050084,
-0x00000013,0x00000139,0x00000136,0x00000138,
-0x00050051,0x00000006,0x0000013b,0x0000012a,
-0x00000000,0x0004007c,0x00000013,0x0000013c,
-0x0000013b,0x00050080,0x00000013,0x0000013d,
-0x00000139,0x0000013c,0x00050080,0x00000013,
-0x00000140,0x00000168,0x0000013d,0x00060041,
-0x00000035,0x00000141,0x000000ca,0x00000017,
-0x00000140,0x000700ea,0x00000013,0x00000142,
-0x00000141,0x00000018,0x00000030,0x00000018,
-0x000200f9,0x00000147,0x000200f8,0x00000147,
-0x000100fd,0x00010038}
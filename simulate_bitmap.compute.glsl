@@ -0,0 +1,68 @@
+#version 450
+
+#define OCCUPANCY_BITMAP
+#include "shared_constants.h"
+// the size is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_PARTICLE_GROUP_SIZE) in;
+#include "bindings.glsl.h"
+#include "occupancy.glsl.h"
+
+// half of the occupancy buffers read this frame
+uint read_parity;
+
+int row_range_sum(int row, int first, int last, bool wrap) {
+	if (last < first) {
+		return 0;
+	}
+
+	if (!wrap) {
+		return occupancy_span_count(read_parity, row, first, last);
+	}
+
+	int width = int(DensityBufferWidth);
+	int start = ((first % width) + width) % width;
+	int end = start + (last - first);
+
+	int sum = occupancy_span_count(read_parity, row, start, min(end, width - 1));
+	if (end >= width) {
+		sum += occupancy_span_count(read_parity, row, 0, end - width);
+	}
+	return sum;
+}
+
+#include "sensing.glsl.h"
+#include "motion.glsl.h"
+
+void main() {
+
+	uint idx = gl_GlobalInvocationID.x;
+
+	if (idx >= ParticleCount) {
+		return;
+	}
+
+	read_parity = bool(frame_number() & 0x1) ? 0 : 1;
+
+	vec2 position = load_position(idx);
+	float angle = load_angle(idx);
+
+	vec2 direction = heading_direction(angle);
+
+	int left = 0;
+	int right = 0;
+	ivec2 density_buffer_position = ivec2(position / DensityBufferDownscale);
+
+	int margin_x = DiscHalfWidths[0];
+	int margin_y = DiscRowCount;
+	bool interior =
+		density_buffer_position.x >= margin_x && density_buffer_position.x < int(DensityBufferWidth) - margin_x &&
+		density_buffer_position.y >= margin_y && density_buffer_position.y < int(DensityBufferHeight) - margin_y;
+
+	if (interior) {
+		count_neighbors(density_buffer_position, direction, false, left, right);
+	} else {
+		count_neighbors(density_buffer_position, direction, true, left, right);
+	}
+
+	step_particle(idx, position, angle, left, right);
+}
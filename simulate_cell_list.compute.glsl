@@ -0,0 +1,107 @@
+#version 450
+#include "shared_constants.h"
+// the size is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_PARTICLE_GROUP_SIZE) in;
+#include "bindings.glsl.h"
+#include "binning.glsl.h"
+#include "motion.glsl.h"
+
+#if FIXED_POINT_MOTION
+// a * b > c * d without overflow
+bool product_greater(int a, int b, int c, int d) {
+	int ab_high, ab_low, cd_high, cd_low;
+	imulExtended(a, b, ab_high, ab_low);
+	imulExtended(c, d, cd_high, cd_low);
+	return (ab_high != cd_high) ? ab_high > cd_high : uint(ab_low) > uint(cd_low);
+}
+
+// x * x + y * y as a 64 bit (low, high) pair, for x and y below 2^31
+uvec2 squared_length(uvec2 offset) {
+	uint x_high, x_low, y_high, y_low, carry;
+	umulExtended(offset.x, offset.x, x_high, x_low);
+	umulExtended(offset.y, offset.y, y_high, y_low);
+	uint low = uaddCarry(x_low, y_low, carry);
+	return uvec2(low, x_high + y_high + carry);
+}
+#endif
+
+// Exact sensing as in the paper: every particle within the sensing radius (in pixels, on the torus) counts,
+// split into left and right by the side of the heading it lies on. Neighbors are found in the 3x3 cells
+// around the particle's cell. Invocations follow bin order, so a workgroup reads the same few cells.
+// With FIXED_POINT_MOTION the positions are whole multiples of 1 / (1 << FIXED_POSITION_BITS) pixels and the
+// directions integers, so the distances and sides are computed exactly in integers.
+void main() {
+	uint slot = gl_GlobalInvocationID.x;
+
+	if (slot >= ParticleCount) {
+		return;
+	}
+
+	uint idx = BinnedParticles[slot];
+	vec2 position = BinnedPositions[slot];
+	float angle = load_angle(idx);
+	vec2 direction = heading_direction(angle);
+
+#if FIXED_POINT_MOTION
+	const float fixed_scale = float(1 << FIXED_POSITION_BITS);
+	ivec2 fixed_size = ImageSize << FIXED_POSITION_BITS;
+	ivec2 fixed_position = ivec2(position * fixed_scale);
+	ivec2 fixed_direction = ivec2(direction);
+	// the radius squared in pixels is SearchRadiusSquared * downscale^2, shifted into fixed point units as 64 bits
+	uint radius_squared_pixels = SearchRadiusSquared * uint(DensityBufferDownscale * DensityBufferDownscale);
+	uvec2 radius_squared = uvec2(radius_squared_pixels << (2 * FIXED_POSITION_BITS), radius_squared_pixels >> (32 - 2 * FIXED_POSITION_BITS));
+#else
+	vec2 image_size = vec2(ImageSize);
+	float radius = sqrt(float(SearchRadiusSquared)) * float(DensityBufferDownscale);
+	float radius_squared = radius * radius;
+#endif
+
+	ivec2 cells = cell_list_size();
+	ivec2 center = particle_cell(position);
+	// with fewer than 3 cells along an axis the neighborhood wraps onto itself, so every cell is visited once instead
+	ivec2 first = mix(ivec2(-1), -center, lessThan(cells, ivec2(3)));
+	ivec2 last = mix(ivec2(1), cells - 1 - center, lessThan(cells, ivec2(3)));
+
+	int left = 0;
+	int right = 0;
+	for (int y = first.y; y <= last.y; ++y) {
+		for (int x = first.x; x <= last.x; ++x) {
+			ivec2 cell = (center + ivec2(x, y) + cells) % cells;
+			uint bin = uint(cell.y * cells.x + cell.x);
+
+			for (uint other = Bins[bin]; other < Bins[bin + 1]; ++other) {
+				if (other == slot) {
+					continue;
+				}
+#if FIXED_POINT_MOTION
+				// the nearest copy on the torus
+				ivec2 offset = ivec2(BinnedPositions[other] * fixed_scale) - fixed_position;
+				offset += mix(ivec2(0), fixed_size, lessThan(2 * offset, -fixed_size));
+				offset -= mix(ivec2(0), fixed_size, greaterThan(2 * offset, fixed_size));
+				uvec2 distance_squared = squared_length(uvec2(abs(offset)));
+				if (distance_squared.y != radius_squared.y ? distance_squared.y > radius_squared.y : distance_squared.x > radius_squared.x) {
+					continue;
+				}
+				if (product_greater(fixed_direction.x, offset.y, fixed_direction.y, offset.x)) {
+					left += 1;
+				} else {
+					right += 1;
+				}
+#else
+				vec2 offset = BinnedPositions[other] - position;
+				offset -= image_size * round(offset / image_size);
+				if (dot(offset, offset) > radius_squared) {
+					continue;
+				}
+				if (direction.x * offset.y - direction.y * offset.x > 0.0) {
+					left += 1;
+				} else {
+					right += 1;
+				}
+#endif
+			}
+		}
+	}
+
+	step_particle(idx, position, angle, left, right);
+}
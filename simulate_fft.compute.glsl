@@ -0,0 +1,35 @@
+#version 450
+#include "shared_constants.h"
+// the size is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_PARTICLE_GROUP_SIZE) in;
+#include "bindings.glsl.h"
+#include "fft.glsl.h"
+#include "motion.glsl.h"
+
+// The heading is rounded to the nearest of FFT_ORIENTATION_BINS directions, and the left and disc counts
+// are single fetches from the convolved responses
+void main() {
+	uint idx = gl_GlobalInvocationID.x;
+
+	if (idx >= ParticleCount) {
+		return;
+	}
+
+	vec2 position = load_position(idx);
+	float angle = load_angle(idx);
+
+#if FIXED_POINT_MOTION
+	const uint half_bin = (1u << FIXED_ANGLE_BITS) / (2 * FFT_ORIENTATION_BINS);
+	int bin = int(((uint(angle) + half_bin) * FFT_ORIENTATION_BINS) >> FIXED_ANGLE_BITS) % FFT_ORIENTATION_BINS;
+#else
+	int bin = int(round(angle * (FFT_ORIENTATION_BINS / TWO_PI)));
+	bin = ((bin % FFT_ORIENTATION_BINS) + FFT_ORIENTATION_BINS) % FFT_ORIENTATION_BINS;
+#endif
+
+	ivec2 density_buffer_position = ivec2(position / DensityBufferDownscale);
+	int left = fft_response(bin, density_buffer_position);
+	// the particle's own cell lies on the dividing line, which counts as right
+	int right = fft_response(FFT_ORIENTATION_BINS, density_buffer_position) - left - 1;
+
+	step_particle(idx, position, angle, left, right);
+}
@@ -0,0 +1,81 @@
+#version 450
+layout(local_size_x = 128) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+#include "binning.glsl.h"
+
+// One workgroup per tile. The tile and a DiscRowCount wide halo of the density field are loaded into
+// shared memory once and turned into row prefix sums there, so the particles of the tile count their
+// neighbors without touching DensityField or RowPrefixSums.
+// The host only builds this pipeline when TileSpan * TileSpan cells fit in maxComputeSharedMemorySize.
+const int TileSpan = SIMULATE_TILE_SIZE + 2 * DiscRowCount;
+shared uint tile_prefix_sums[TileSpan * TileSpan];
+
+// density buffer cell held at tile_prefix_sums[0]
+ivec2 tile_origin;
+
+int row_range_sum(int row, int first, int last, bool wrap) {
+	if (last < first) {
+		return 0;
+	}
+
+	// the halo was loaded with wrapping, so neighborhoods of the tile's particles never leave the shared copy
+	uint row_start = uint(row - tile_origin.y) * TileSpan;
+	int local_first = first - tile_origin.x;
+	int local_last = last - tile_origin.x;
+
+	uint sum = tile_prefix_sums[row_start + local_last];
+	if (local_first > 0) {
+		sum -= tile_prefix_sums[row_start + local_first - 1];
+	}
+	return int(sum);
+}
+
+#include "sensing.glsl.h"
+#include "motion.glsl.h"
+
+void main() {
+	uint lane = gl_LocalInvocationID.x;
+	uint tile = gl_WorkGroupID.y * tile_count_x() + gl_WorkGroupID.x;
+	tile_origin = ivec2(gl_WorkGroupID.xy) * SIMULATE_TILE_SIZE - DiscRowCount;
+
+	uint particles_begin = Bins[tile];
+	uint particles_end = Bins[tile + 1];
+	if (particles_begin == particles_end) {
+		return;
+	}
+
+	uint read_offset = density_read_offset();
+	ivec2 density_buffer_size = ivec2(DensityBufferWidth, DensityBufferHeight);
+
+	for (uint i = lane; i < TileSpan * TileSpan; i += gl_WorkGroupSize.x) {
+		ivec2 cell = tile_origin + ivec2(i % TileSpan, i / TileSpan);
+		cell = (cell % density_buffer_size + density_buffer_size) % density_buffer_size;
+		tile_prefix_sums[i] = DensityField[read_offset + density_index(cell)];
+	}
+	barrier();
+
+	for (uint row = lane; row < TileSpan; row += gl_WorkGroupSize.x) {
+		uint row_start = row * TileSpan;
+		for (uint x = 1; x < TileSpan; ++x) {
+			tile_prefix_sums[row_start + x] += tile_prefix_sums[row_start + x - 1];
+		}
+	}
+	barrier();
+
+	for (uint i = particles_begin + lane; i < particles_end; i += gl_WorkGroupSize.x) {
+		uint idx = BinnedParticles[i];
+		vec2 position = load_position(idx);
+		float angle = load_angle(idx);
+
+		vec2 direction = heading_direction(angle);
+		ivec2 density_buffer_position = ivec2(position / DensityBufferDownscale);
+
+		int left = 0;
+		int right = 0;
+		count_neighbors(density_buffer_position, direction, false, left, right);
+
+		step_particle(idx, position, angle, left, right);
+	}
+}
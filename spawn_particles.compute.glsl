@@ -0,0 +1,35 @@
+#version 450
+layout(local_size_x = 128) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+
+// Appends SpawnCount particles after the live ones, spread uniformly over the edit region with random headings.
+// Particles past MAX_PARTICLE_COUNT are dropped. ParticleCount is left alone, so that every invocation sees
+// the same start, and update_particle_count applies the new count afterwards.
+void main() {
+	uint i = gl_GlobalInvocationID.x;
+	uint slot = ParticleCount + i;
+
+	if (i == 0) {
+		PendingParticleCount = min(ParticleCount + SpawnCount, MAX_PARTICLE_COUNT);
+	}
+	if (i >= SpawnCount || slot >= MAX_PARTICLE_COUNT) {
+		return;
+	}
+
+	uint random_seed = init_seed(SpawnSeed + i);
+	float radius = EditRegionRadius * sqrt(random(random_seed));
+	float angle = random(random_seed) * TWO_PI;
+	vec2 position = vec2(EditRegionX, EditRegionY) + radius * vec2(cos(angle), sin(angle));
+	position = mod(position, vec2(ImageSize));
+	position = store_new_particle(slot, position, random_seed);
+#if TRACK_PARTICLE_IDS
+	ParticleIds[slot] = NextParticleId + i;
+#endif
+
+	// a rebuilt density field picks the particle up with its first step
+	if (IncrementalDensity != 0 && DensityBufferLength != 0) {
+		deposit_density(density_index(ivec2(position / DensityBufferDownscale)));
+	}
+}
@@ -0,0 +1,62 @@
+// Specialization constants. The host fills these in when it builds a pipeline variant
+// (see simulation_params in main.cpp), so the values below are only the defaults.
+layout(constant_id = SPEC_ID_SEARCH_RADIUS_SQUARED) const int SearchRadiusSquared = 128;
+layout(constant_id = SPEC_ID_ALPHA) const float Alpha = 5.0;
+layout(constant_id = SPEC_ID_BETA) const float Beta = 12.0;
+layout(constant_id = SPEC_ID_DENSITY_BUFFER_DOWNSCALE) const int DensityBufferDownscale = DENSITY_BUFFER_DOWNSCALE;
+// BIN_KEY_*, selects what the binning passes in binning.glsl.h bucket particles by
+layout(constant_id = SPEC_ID_BIN_KEY) const int BinKey = BIN_KEY_TILE;
+// smallest cell size (in pixels) of the cell list, the sensing radius rounded up
+layout(constant_id = SPEC_ID_CELL_LIST_CELL_SIZE) const int CellListCellSize = 12;
+// which lines of which FftLayers the fft_lines pass transforms: rows (0) or columns (1), starting at FftFirstLayer
+layout(constant_id = SPEC_ID_FFT_AXIS) const int FftAxis = 0;
+layout(constant_id = SPEC_ID_FFT_INVERSE) const bool FftInverse = false;
+layout(constant_id = SPEC_ID_FFT_FIRST_LAYER) const int FftFirstLayer = 0;
+// Alpha and Beta in binary angle units, rounded on the host, for FIXED_POINT_MOTION
+layout(constant_id = SPEC_ID_FIXED_ALPHA) const int FixedAlpha = 910;
+layout(constant_id = SPEC_ID_FIXED_BETA) const int FixedBeta = 2185;
+
+// Disc offset table, precomputed on the host for each variant:
+// DiscHalfWidths[abs(y)] is the largest x with x*x + y*y <= SearchRadiusSquared, or -1 past the last row
+layout(constant_id = SPEC_ID_DISC_ROW_COUNT) const int DiscRowCount = 11;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 0) const int DiscHalfWidth0 = 11;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 1) const int DiscHalfWidth1 = 11;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 2) const int DiscHalfWidth2 = 11;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 3) const int DiscHalfWidth3 = 10;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 4) const int DiscHalfWidth4 = 10;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 5) const int DiscHalfWidth5 = 10;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 6) const int DiscHalfWidth6 = 9;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 7) const int DiscHalfWidth7 = 8;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 8) const int DiscHalfWidth8 = 8;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 9) const int DiscHalfWidth9 = 6;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 10) const int DiscHalfWidth10 = 5;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 11) const int DiscHalfWidth11 = 2;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 12) const int DiscHalfWidth12 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 13) const int DiscHalfWidth13 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 14) const int DiscHalfWidth14 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 15) const int DiscHalfWidth15 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 16) const int DiscHalfWidth16 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 17) const int DiscHalfWidth17 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 18) const int DiscHalfWidth18 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 19) const int DiscHalfWidth19 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 20) const int DiscHalfWidth20 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 21) const int DiscHalfWidth21 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 22) const int DiscHalfWidth22 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 23) const int DiscHalfWidth23 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 24) const int DiscHalfWidth24 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 25) const int DiscHalfWidth25 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 26) const int DiscHalfWidth26 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 27) const int DiscHalfWidth27 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 28) const int DiscHalfWidth28 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 29) const int DiscHalfWidth29 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 30) const int DiscHalfWidth30 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 31) const int DiscHalfWidth31 = -1;
+layout(constant_id = SPEC_ID_DISC_HALF_WIDTHS + 32) const int DiscHalfWidth32 = -1;
+
+const int DiscHalfWidths[MAX_DISC_ROWS + 1] = int[](
+	DiscHalfWidth0, DiscHalfWidth1, DiscHalfWidth2, DiscHalfWidth3, DiscHalfWidth4, DiscHalfWidth5, DiscHalfWidth6, DiscHalfWidth7,
+	DiscHalfWidth8, DiscHalfWidth9, DiscHalfWidth10, DiscHalfWidth11, DiscHalfWidth12, DiscHalfWidth13, DiscHalfWidth14, DiscHalfWidth15,
+	DiscHalfWidth16, DiscHalfWidth17, DiscHalfWidth18, DiscHalfWidth19, DiscHalfWidth20, DiscHalfWidth21, DiscHalfWidth22, DiscHalfWidth23,
+	DiscHalfWidth24, DiscHalfWidth25, DiscHalfWidth26, DiscHalfWidth27, DiscHalfWidth28, DiscHalfWidth29, DiscHalfWidth30, DiscHalfWidth31,
+	DiscHalfWidth32
+);
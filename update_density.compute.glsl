@@ -0,0 +1,25 @@
+#version 450
+#include "shared_constants.h"
+// the size is tuned per device, see workgroup_tuning in main.cpp
+layout(local_size_x_id = SPEC_ID_PARTICLE_GROUP_SIZE) in;
+#include "bindings.glsl.h"
+
+// IncrementalDensity: runs after the simulate kernel, so every particle has finished sensing before any count moves.
+// A particle that left its cell takes one particle off the old cell and adds one to the new cell;
+// the others cost nothing beyond reading their position.
+void main() {
+	uint idx = gl_GlobalInvocationID.x;
+
+	if (idx >= ParticleCount) {
+		return;
+	}
+
+	uint previous = MovedFromCells[idx];
+	uint current = density_index(ivec2(load_position(idx) / DensityBufferDownscale));
+	if (previous == current) {
+		return;
+	}
+
+	atomicAdd(DensityField[previous], ~0u);
+	atomicAdd(DensityField[current], 1u);
+}
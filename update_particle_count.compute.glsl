@@ -0,0 +1,22 @@
+#version 450
+layout(local_size_x = 1) in;
+
+#include "shared_constants.h"
+#include "bindings.glsl.h"
+
+// the workgroup size of the tuned particle kernels, which use it as local_size_x_id
+layout(constant_id = SPEC_ID_PARTICLE_GROUP_SIZE) const uint ParticleGroupSize = 128;
+
+// Applies the count that spawn_particles or compact_particles left in PendingParticleCount. Outside of those the
+// two are equal, so this also rebuilds the dispatch arguments after the workgroup size changed.
+void main() {
+	uint count = PendingParticleCount;
+	if (count > ParticleCount) {
+		NextParticleId += count - ParticleCount;
+	}
+	ParticleCount = count;
+	ParticleDispatch = uvec3((count + 127) / 128, 1, 1);
+	TunedParticleDispatch[0] = (count + ParticleGroupSize - 1) / ParticleGroupSize;
+	TunedParticleDispatch[1] = 1;
+	TunedParticleDispatch[2] = 1;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <mutex>
+#include <string.h>
+
 typedef void (*VulkanCleanupCallback)();
 struct vulkan_cleanup_task {
 	VulkanCleanupCallback Callback;
@@ -55,6 +58,32 @@ static inline VkSemaphore VulkanCreateSemaphore(VkDevice Device) {
 	return Result;
 }
 
+static inline VkSemaphore VulkanCreateTimelineSemaphore(VkDevice Device, u64 InitialValue) {
+	VkSemaphoreTypeCreateInfo TypeCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = InitialValue
+	};
+	VkSemaphoreCreateInfo SemaphoreCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &TypeCreateInfo
+	};
+	VkSemaphore Result = 0;
+	RuntimeAssert(vkCreateSemaphore(Device, &SemaphoreCreateInfo, NULL, &Result) == VK_SUCCESS);
+	return Result;
+}
+
+// Blocks until the timeline semaphore reaches Value
+static inline void VulkanWaitTimelineSemaphore(VkDevice Device, VkSemaphore Semaphore, u64 Value) {
+	VkSemaphoreWaitInfo WaitInfo = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.semaphoreCount = 1,
+		.pSemaphores = &Semaphore,
+		.pValues = &Value
+	};
+	RuntimeAssert(vkWaitSemaphores(Device, &WaitInfo, UINT64_MAX) == VK_SUCCESS);
+}
+
 static inline void VulkanBeginCommands(VkCommandBuffer CommandBuffer, VkCommandBufferUsageFlags Usage) {
 	VkCommandBufferBeginInfo BeginInfo = {
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -116,13 +145,15 @@ struct cmd_image_transition {
 	VkAccessFlags AccessFlags;
 };
 
-static inline void CmdTransitionImageLayout(VkCommandBuffer CommandBuffer, VkImage Image, const cmd_image_transition &Src, const cmd_image_transition &Dst) {
+// With two different queue families this is one half of an ownership transfer, and has to be recorded on both queues
+static inline void CmdTransitionImageLayout(VkCommandBuffer CommandBuffer, VkImage Image, const cmd_image_transition &Src, const cmd_image_transition &Dst,
+	u32 SrcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, u32 DstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED) {
     VkImageMemoryBarrier Barrier = {};
     Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     Barrier.oldLayout = Src.ImageLayout;
     Barrier.newLayout = Dst.ImageLayout;
-    Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    Barrier.srcQueueFamilyIndex = SrcQueueFamilyIndex;
+    Barrier.dstQueueFamilyIndex = DstQueueFamilyIndex;
     Barrier.image = Image;
     Barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     Barrier.subresourceRange.baseMipLevel = 0;
@@ -151,6 +182,16 @@ static inline void CmdBufferMemoryBarrier(VkCommandBuffer CommandBuffer, VkBuffe
 	vkCmdPipelineBarrier(CommandBuffer, Src.PipelineStage, Dst.PipelineStage, 0, 0, NULL, 1, &Barrier, 0, NULL);
 }
 
+// Global memory barrier, which also covers images that stay in the same layout
+static inline void CmdMemoryBarrier(VkCommandBuffer CommandBuffer, const cmd_buffer_memory_barrier &Src, const cmd_buffer_memory_barrier &Dst) {
+	VkMemoryBarrier Barrier = {};
+	Barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	Barrier.srcAccessMask = Src.AccessFlags;
+	Barrier.dstAccessMask = Dst.AccessFlags;
+
+	vkCmdPipelineBarrier(CommandBuffer, Src.PipelineStage, Dst.PipelineStage, 0, 1, &Barrier, 0, NULL, 0, NULL);
+}
+
 static void CmdBlit2DImage(VkCommandBuffer CommandBuffer, VkImage SrcImage, VkImage DstImage, const v2i &SrcResolution, const v2i &DstResolution, VkFilter Filter = VK_FILTER_NEAREST) {
     VkImageBlit BlitRegion = {};
 
@@ -201,7 +242,7 @@ static vk_format_and_color VulkanGetBestAvailableFormatAndColor(VkPhysicalDevice
 	return { Format, ColorSpace };
 }
 
-static VkSwapchainKHR VulkanCreateSwapchain(VkDevice Device, VkSurfaceKHR Surface, vk_format_and_color FormatAndColor, v2i WindowResolution) {
+static VkSwapchainKHR VulkanCreateSwapchain(VkDevice Device, VkSurfaceKHR Surface, vk_format_and_color FormatAndColor, v2i WindowResolution, VkImageUsageFlags ExtraUsage = 0) {
 
 	VkFormat Format = FormatAndColor.Format;
 	VkColorSpaceKHR ColorSpace = FormatAndColor.ColorSpace;
@@ -213,7 +254,7 @@ static VkSwapchainKHR VulkanCreateSwapchain(VkDevice Device, VkSurfaceKHR Surfac
 		.imageColorSpace = ColorSpace,
 		.imageExtent = { (u32)WindowWidth, (u32)WindowHeight },
 		.imageArrayLayers = 1,
-		.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+		.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | ExtraUsage,
 		.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
 		.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
 		.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
@@ -238,16 +279,102 @@ static VkShaderModule VulkanCreateShaderModule(range<u32> ShaderByteCode) {
 	return Result;
 }
 
-static VkPipeline VulkanCreateComputeShaderPipeline(range<u32> ShaderByteCode, VkPipelineLayout PipelineLayout) {
+struct vk_compute_pipeline_cache_entry {
+	const u32 *ShaderByteCode;
+	VkPipelineLayout PipelineLayout;
+	u32 SpecializationDataSize;
+	u8 SpecializationData[256];
+	VkPipeline Pipeline;
+	u32 Holds; // callers of VulkanCreateComputeShaderPipeline that have not released it yet; held entries are never evicted
+	u64 LastUse; // ComputePipelineCache.Clock at the last lookup, for least recently used eviction
+	u64 RetireValue; // see VulkanReleaseComputePipeline
+};
+// an evicted pipeline, destroyed once RetireValue is reached
+struct vk_retired_compute_pipeline {
+	VkPipeline Pipeline;
+	u64 RetireValue;
+};
+struct vk_compute_pipeline_cache {
+	std::mutex Mutex;
+	vk_compute_pipeline_cache_entry Entries[256];
+	u32 Count;
+	u64 Clock;
+	vk_retired_compute_pipeline Retired[256];
+	u32 RetiredCount;
+};
+static vk_compute_pipeline_cache ComputePipelineCache;
+
+static vk_compute_pipeline_cache_entry *FindCachedComputePipeline(range<u32> ShaderByteCode, VkPipelineLayout PipelineLayout, const VkSpecializationInfo *SpecializationInfo) {
+	u32 SpecializationDataSize = (SpecializationInfo) ? (u32)SpecializationInfo->dataSize : 0;
+	for (u32 i = 0; i < ComputePipelineCache.Count; ++i) {
+		vk_compute_pipeline_cache_entry *Entry = ComputePipelineCache.Entries + i;
+		if (Entry->ShaderByteCode == ShaderByteCode.Data &&
+			Entry->PipelineLayout == PipelineLayout &&
+			Entry->SpecializationDataSize == SpecializationDataSize &&
+			(SpecializationDataSize == 0 || memcmp(Entry->SpecializationData, SpecializationInfo->pData, SpecializationDataSize) == 0)) {
+			return Entry;
+		}
+	}
+	return NULL;
+}
+
+// Moves the least recently used entry nobody holds to the retired list. Returns false when every entry is held or
+// the retired list is full. Called with the mutex locked.
+static bool EvictCachedComputePipeline() {
+	if (ComputePipelineCache.RetiredCount == ArrayLen(ComputePipelineCache.Retired)) {
+		return false;
+	}
+	u32 Victim = ComputePipelineCache.Count;
+	for (u32 i = 0; i < ComputePipelineCache.Count; ++i) {
+		const vk_compute_pipeline_cache_entry &Entry = ComputePipelineCache.Entries[i];
+		if (Entry.Holds == 0 && (Victim == ComputePipelineCache.Count || Entry.LastUse < ComputePipelineCache.Entries[Victim].LastUse)) {
+			Victim = i;
+		}
+	}
+	if (Victim == ComputePipelineCache.Count) {
+		return false;
+	}
+	const vk_compute_pipeline_cache_entry &Entry = ComputePipelineCache.Entries[Victim];
+	ComputePipelineCache.Retired[ComputePipelineCache.RetiredCount++] = { Entry.Pipeline, Entry.RetireValue };
+	ComputePipelineCache.Entries[Victim] = ComputePipelineCache.Entries[--ComputePipelineCache.Count];
+	return true;
+}
+
+// Pipelines are cached by shader, layout and specialization data, so rebuilding a variant that was used before is free.
+// Every call holds the returned pipeline until VulkanReleaseComputePipeline; released pipelines stay cached until they
+// are evicted to make room. Returns VK_NULL_HANDLE when the pipeline fails to build or every cache entry is held.
+// Safe to call from a worker thread.
+static VkPipeline VulkanCreateComputeShaderPipeline(range<u32> ShaderByteCode, VkPipelineLayout PipelineLayout, const VkSpecializationInfo *SpecializationInfo = NULL) {
+
+	u32 SpecializationDataSize = (SpecializationInfo) ? (u32)SpecializationInfo->dataSize : 0;
+	RuntimeAssert(SpecializationDataSize <= sizeof(vk_compute_pipeline_cache_entry::SpecializationData));
+	{
+		std::lock_guard<std::mutex> Lock(ComputePipelineCache.Mutex);
+		vk_compute_pipeline_cache_entry *Entry = FindCachedComputePipeline(ShaderByteCode, PipelineLayout, SpecializationInfo);
+		if (Entry) {
+			Entry->Holds += 1;
+			Entry->LastUse = ++ComputePipelineCache.Clock;
+			return Entry->Pipeline;
+		}
+	}
 
-	VkShaderModule ShaderModule = VulkanCreateShaderModule(ShaderByteCode);
+	VkShaderModuleCreateInfo ShaderModuleCreateInfo = {
+		.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		.codeSize = ShaderByteCode.Length * 4,
+		.pCode = ShaderByteCode.Data
+	};
+	VkShaderModule ShaderModule = 0;
+	if (vkCreateShaderModule(Device, &ShaderModuleCreateInfo, NULL, &ShaderModule) != VK_SUCCESS) {
+		return VK_NULL_HANDLE;
+	}
 	OnScopeExit(vkDestroyShaderModule(Device, ShaderModule, NULL));
 
 	VkPipelineShaderStageCreateInfo ShaderStageCreateInfo = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
 		.stage = VK_SHADER_STAGE_COMPUTE_BIT,
 		.module = ShaderModule,
-		.pName = "main"
+		.pName = "main",
+		.pSpecializationInfo = SpecializationInfo
 	};
 	VkComputePipelineCreateInfo PipelineCreateInfo = {
 		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
@@ -255,6 +382,74 @@ static VkPipeline VulkanCreateComputeShaderPipeline(range<u32> ShaderByteCode, V
 		.layout = PipelineLayout
 	};
 	VkPipeline Result = 0;
-	RuntimeAssert(vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, NULL, &Result) == VK_SUCCESS);
+	if (vkCreateComputePipelines(Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, NULL, &Result) != VK_SUCCESS) {
+		return VK_NULL_HANDLE;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(ComputePipelineCache.Mutex);
+		if (ComputePipelineCache.Count == ArrayLen(ComputePipelineCache.Entries) && !EvictCachedComputePipeline()) {
+			// never handed out, so nothing can be using it
+			vkDestroyPipeline(Device, Result, NULL);
+			return VK_NULL_HANDLE;
+		}
+
+		vk_compute_pipeline_cache_entry *Entry = ComputePipelineCache.Entries + ComputePipelineCache.Count++;
+		Entry->ShaderByteCode = ShaderByteCode.Data;
+		Entry->PipelineLayout = PipelineLayout;
+		Entry->SpecializationDataSize = SpecializationDataSize;
+		if (SpecializationInfo) {
+			memcpy(Entry->SpecializationData, SpecializationInfo->pData, SpecializationDataSize);
+		}
+		Entry->Pipeline = Result;
+		Entry->Holds = 1;
+		Entry->LastUse = ++ComputePipelineCache.Clock;
+		Entry->RetireValue = 0;
+	}
+
 	return Result;
 }
+
+// Drops one hold on Pipeline. RetireValue is a value of the caller's frame timeline after which no submitted work
+// uses the pipeline anymore; an evicted pipeline is only destroyed once VulkanDestroyRetiredComputePipelines sees it.
+static void VulkanReleaseComputePipeline(VkPipeline Pipeline, u64 RetireValue) {
+	if (!Pipeline) {
+		return;
+	}
+	std::lock_guard<std::mutex> Lock(ComputePipelineCache.Mutex);
+	for (u32 i = 0; i < ComputePipelineCache.Count; ++i) {
+		vk_compute_pipeline_cache_entry &Entry = ComputePipelineCache.Entries[i];
+		if (Entry.Pipeline == Pipeline) {
+			RuntimeAssert(Entry.Holds > 0);
+			Entry.Holds -= 1;
+			Entry.RetireValue = (RetireValue > Entry.RetireValue) ? RetireValue : Entry.RetireValue;
+			return;
+		}
+	}
+}
+
+// Destroys the evicted pipelines whose RetireValue is at most CompletedValue
+static void VulkanDestroyRetiredComputePipelines(u64 CompletedValue) {
+	std::lock_guard<std::mutex> Lock(ComputePipelineCache.Mutex);
+	for (u32 i = 0; i < ComputePipelineCache.RetiredCount;) {
+		if (ComputePipelineCache.Retired[i].RetireValue <= CompletedValue) {
+			vkDestroyPipeline(Device, ComputePipelineCache.Retired[i].Pipeline, NULL);
+			ComputePipelineCache.Retired[i] = ComputePipelineCache.Retired[--ComputePipelineCache.RetiredCount];
+		} else {
+			++i;
+		}
+	}
+}
+
+// Destroys every pipeline, held or not; only once the device is idle
+static void VulkanDestroyCachedComputePipelines() {
+	std::lock_guard<std::mutex> Lock(ComputePipelineCache.Mutex);
+	for (u32 i = 0; i < ComputePipelineCache.Count; ++i) {
+		vkDestroyPipeline(Device, ComputePipelineCache.Entries[i].Pipeline, NULL);
+	}
+	for (u32 i = 0; i < ComputePipelineCache.RetiredCount; ++i) {
+		vkDestroyPipeline(Device, ComputePipelineCache.Retired[i].Pipeline, NULL);
+	}
+	ComputePipelineCache.Count = 0;
+	ComputePipelineCache.RetiredCount = 0;
+}